@@ -0,0 +1,495 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "asyncout.h"
+
+/* Worker threads for ASYNC_POOL, and how many writes each takes at once */
+#define POOL_THREADS 4
+#define POOL_BATCH 32
+
+/* user_data of the no-op that tells the io_uring reaper to exit */
+#define STOP_TAG UINT64_MAX
+/* How long the kernel's submission thread spins before sleeping */
+#define SQ_IDLE_MS 10
+
+/* One in-flight write; its buffer is reused once the write completes */
+struct slot {
+    char *buf;
+    size_t len;
+    off_t off;
+    uint64_t submitted_ns;
+    int queued;                        /* On the io_uring; set under sq_lock */
+};
+
+static int out_fd = -1;
+static enum async_backend active;
+static struct slot *slots;
+static char *slot_bufs;
+static unsigned nslots;
+static size_t slot_max;
+static atomic_ullong next_off;         /* End of the reserved region */
+static struct hist write_latency;
+static atomic_ulong completed;
+static atomic_ulong reaped_batches;
+
+/* Free slot indices: a stack under free_lock, counted by free_count */
+static pthread_mutex_t free_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned *free_stack;
+static unsigned free_top;
+static sem_t free_count;
+
+/* io_uring rings, mapped from the kernel */
+static int ring_fd = -1;
+static void *sq_map, *cq_map;
+static size_t sq_map_len, cq_map_len, sqes_len;
+static unsigned *sq_tail, *sq_mask, *sq_array, *sq_flags;
+static unsigned *cq_head, *cq_tail, *cq_mask;
+static struct io_uring_sqe *sqes;
+static struct io_uring_cqe *cqes;
+static pthread_mutex_t sq_lock = PTHREAD_MUTEX_INITIALIZER;
+static int uring_dead;                 /* Reaper gave up; under sq_lock */
+static pthread_t reaper;
+static unsigned *reaped;               /* Reaper's scratch list of slots */
+
+/* ASYNC_POOL: slots waiting for a worker, a ring of nslots under queue_lock */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static unsigned *queue;
+static unsigned queue_head, queue_len;
+static int pool_stop;
+static pthread_t pool[POOL_THREADS];
+
+/*
+ * Takes a free slot, waiting for a completion if all are in flight.
+ */
+static unsigned take_slot(void) {
+    while (sem_wait(&free_count) != 0) {
+        /* EINTR: try again */
+    }
+    pthread_mutex_lock(&free_lock);
+    unsigned idx = free_stack[--free_top];
+    pthread_mutex_unlock(&free_lock);
+    return idx;
+}
+
+/*
+ * Returns n completed slots to the free stack in one go.
+ */
+static void put_slots(const unsigned *idx, unsigned n) {
+    pthread_mutex_lock(&free_lock);
+    for (unsigned i = 0; i < n; i++) {
+        free_stack[free_top++] = idx[i];
+    }
+    pthread_mutex_unlock(&free_lock);
+    for (unsigned i = 0; i < n; i++) {
+        sem_post(&free_count);
+    }
+}
+
+/*
+ * Writes whatever of slot s is left after its first done bytes, then
+ * records the write's latency.
+ */
+static void finish_write(struct slot *s, size_t done) {
+    while (done < s->len) {
+        ssize_t n = pwrite(out_fd, s->buf + done, s->len - done, s->off + done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("pwrite");
+            break;
+        }
+        done += n;
+    }
+    hist_add(&write_latency, now_ns() - s->submitted_ns);
+    atomic_fetch_add_explicit(&completed, 1, memory_order_relaxed);
+}
+
+static int uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+static int uring_register(unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+/*
+ * Puts one request on the submission queue. The ring runs in SQPOLL mode,
+ * so a kernel thread picks the entry up; we only make a system call when
+ * that thread has gone to sleep. (Requests submitted by a bot thread
+ * itself would be cancelled if the bot exited before they ran.) The lock
+ * only orders producers on the queue tail.
+ * @return 0 if queued, -1 if the reaper has given up and the caller must
+ *         do the write itself
+ */
+static int uring_submit(uint8_t opcode, struct slot *s, uint64_t tag) {
+    pthread_mutex_lock(&sq_lock);
+    if (uring_dead) {
+        pthread_mutex_unlock(&sq_lock);
+        return -1;
+    }
+    unsigned tail = *sq_tail;
+    unsigned i = tail & *sq_mask;
+    struct io_uring_sqe *sqe = &sqes[i];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    if (s) {
+        sqe->fd = 0;                   /* out_fd's index in the file table */
+        sqe->flags = IOSQE_FIXED_FILE;
+        sqe->addr = (uintptr_t)s->buf;
+        sqe->len = s->len;
+        sqe->off = s->off;
+        s->queued = 1;
+    }
+    sqe->user_data = tag;
+    sq_array[i] = i;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&sq_lock);
+
+    /* Pairs with the kernel's barrier between setting NEED_WAKEUP and
+     * rechecking the tail, so one side always sees the other */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) {
+        while (uring_enter(0, 0, IORING_ENTER_SQ_WAKEUP) < 0 && errno == EINTR) {
+        }
+    }
+    return 0;
+}
+
+/*
+ * Called by the reaper when it can no longer wait for completions: stops
+ * further submissions, then writes every request still on the ring with
+ * pwrite() and frees its slot, so writers and async_out_close() don't
+ * wait for completions that will never be reaped.
+ */
+static void uring_abandon(void) {
+    unsigned n = 0;
+    pthread_mutex_lock(&sq_lock);
+    uring_dead = 1;
+    for (unsigned i = 0; i < nslots; i++) {
+        if (slots[i].queued) {
+            slots[i].queued = 0;
+            reaped[n++] = i;
+        }
+    }
+    pthread_mutex_unlock(&sq_lock);
+
+    for (unsigned i = 0; i < n; i++) {
+        finish_write(&slots[reaped[i]], 0);
+    }
+    put_slots(reaped, n);
+}
+
+/*
+ * io_uring reaper: sleeps until at least one write completes, then takes
+ * every completion that has arrived and frees their slots together.
+ */
+static void *uring_reaper(void *arg) {
+    (void)arg;
+    int stop = 0;
+    while (!stop) {
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            if (uring_enter(0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+                errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                perror("io_uring_enter, writing synchronously");
+                uring_abandon();
+                return NULL;
+            }
+            continue;
+        }
+
+        unsigned n = 0;
+        for (; head != tail; head++) {
+            const struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+            if (cqe->user_data == STOP_TAG) {
+                stop = 1;
+                continue;
+            }
+            struct slot *s = &slots[cqe->user_data];
+            s->queued = 0;
+            if (cqe->res < 0) {
+                /* Retry the whole record with pwrite(), which reports
+                 * anything that fails again */
+                finish_write(s, 0);
+            } else {
+                finish_write(s, (size_t)cqe->res);  /* Completes a short write */
+            }
+            reaped[n++] = (unsigned)cqe->user_data;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        put_slots(reaped, n);
+        atomic_fetch_add_explicit(&reaped_batches, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void uring_teardown(void) {
+    munmap(sqes, sqes_len);
+    munmap(cq_map, cq_map_len);
+    munmap(sq_map, sq_map_len);
+    close(ring_fd);
+    ring_fd = -1;
+}
+
+/*
+ * Checks that this kernel can do what uring_submit() asks of it: the
+ * output file must go in the ring's file table, since before Linux 5.11
+ * the submission thread can't use ordinary descriptors, and
+ * IORING_OP_WRITE only exists from 5.6.
+ * @return 0 if so, -1 otherwise (errno set)
+ */
+static int uring_probe(void) {
+    if (uring_register(IORING_REGISTER_FILES, &out_fd, 1) != 0) {
+        return -1;
+    }
+    size_t len = sizeof(struct io_uring_probe) +
+                 IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, len);
+    if (!probe) {
+        return -1;
+    }
+    int ok = uring_register(IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0 &&
+             probe->last_op >= IORING_OP_WRITE &&
+             (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    if (!ok) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Creates a ring with room for every slot and a kernel submission
+ * thread, maps its queues and starts the reaper.
+ * @return 0 on success, -1 if io_uring can't be used here
+ */
+static int uring_init(void) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_SQPOLL;
+    p.sq_thread_idle = SQ_IDLE_MS;
+    ring_fd = uring_setup(nslots, &p);
+    if (ring_fd < 0) {
+        return -1;
+    }
+
+    sq_map_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_map_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    sq_map = mmap(NULL, sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_fd, IORING_OFF_SQ_RING);
+    cq_map = mmap(NULL, cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_fd, IORING_OFF_CQ_RING);
+    sqes = mmap(NULL, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring_fd, IORING_OFF_SQES);
+    if (sq_map == MAP_FAILED || cq_map == MAP_FAILED || sqes == MAP_FAILED) {
+        int err = errno;
+        if (sq_map != MAP_FAILED) munmap(sq_map, sq_map_len);
+        if (cq_map != MAP_FAILED) munmap(cq_map, cq_map_len);
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_len);
+        close(ring_fd);
+        ring_fd = -1;
+        errno = err;
+        return -1;
+    }
+    sq_tail = (unsigned *)((char *)sq_map + p.sq_off.tail);
+    sq_mask = (unsigned *)((char *)sq_map + p.sq_off.ring_mask);
+    sq_array = (unsigned *)((char *)sq_map + p.sq_off.array);
+    sq_flags = (unsigned *)((char *)sq_map + p.sq_off.flags);
+    cq_head = (unsigned *)((char *)cq_map + p.cq_off.head);
+    cq_tail = (unsigned *)((char *)cq_map + p.cq_off.tail);
+    cq_mask = (unsigned *)((char *)cq_map + p.cq_off.ring_mask);
+    cqes = (struct io_uring_cqe *)((char *)cq_map + p.cq_off.cqes);
+    if (uring_probe() != 0) {
+        int err = errno;
+        uring_teardown();
+        errno = err;
+        return -1;
+    }
+
+    reaped = malloc(nslots * sizeof(*reaped));
+    if (!reaped || pthread_create(&reaper, NULL, uring_reaper, NULL) != 0) {
+        perror("uring_init");
+        exit(EXIT_FAILURE);
+    }
+    return 0;
+}
+
+/*
+ * ASYNC_POOL worker: takes up to POOL_BATCH queued writes at a time,
+ * issues them and frees their slots together.
+ */
+static void *pool_worker(void *arg) {
+    (void)arg;
+    unsigned batch[POOL_BATCH];
+    for (;;) {
+        pthread_mutex_lock(&queue_lock);
+        while (queue_len == 0 && !pool_stop) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+        if (queue_len == 0) {
+            pthread_mutex_unlock(&queue_lock);
+            return NULL;
+        }
+        unsigned n = 0;
+        while (queue_len > 0 && n < POOL_BATCH) {
+            batch[n++] = queue[queue_head];
+            queue_head = (queue_head + 1) % nslots;
+            queue_len--;
+        }
+        pthread_mutex_unlock(&queue_lock);
+
+        for (unsigned i = 0; i < n; i++) {
+            finish_write(&slots[batch[i]], 0);
+        }
+        put_slots(batch, n);
+        atomic_fetch_add_explicit(&reaped_batches, 1, memory_order_relaxed);
+    }
+}
+
+static void pool_init(void) {
+    queue = malloc(nslots * sizeof(*queue));
+    if (!queue) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < POOL_THREADS; i++) {
+        if (pthread_create(&pool[i], NULL, pool_worker, NULL) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void pool_submit(unsigned idx) {
+    pthread_mutex_lock(&queue_lock);
+    queue[(queue_head + queue_len) % nslots] = idx;
+    queue_len++;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+int async_out_init(const char *path, enum async_backend backend,
+                   unsigned depth, size_t rec_max) {
+    out_fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (out_fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(out_fd, &st) != 0) {
+        close(out_fd);
+        return -1;
+    }
+    atomic_store(&next_off, (unsigned long long)st.st_size);
+    hist_init(&write_latency);
+
+    nslots = depth;
+    slot_max = rec_max;
+    slots = calloc(nslots, sizeof(*slots));
+    slot_bufs = malloc((size_t)nslots * slot_max);
+    free_stack = malloc(nslots * sizeof(*free_stack));
+    if (!slots || !slot_bufs || !free_stack || sem_init(&free_count, 0, nslots) != 0) {
+        close(out_fd);
+        errno = ENOMEM;
+        return -1;
+    }
+    for (unsigned i = 0; i < nslots; i++) {
+        slots[i].buf = slot_bufs + (size_t)i * slot_max;
+        free_stack[i] = nslots - 1 - i;
+    }
+    free_top = nslots;
+
+    active = backend;
+    if (active == ASYNC_URING && uring_init() != 0) {
+        perror("io_uring unavailable, using thread pool");
+        active = ASYNC_POOL;
+    }
+    if (active == ASYNC_POOL) {
+        pool_init();
+    }
+    return 0;
+}
+
+int async_out_append(const char *rec, size_t len) {
+    if (len > slot_max) {
+        errno = EINVAL;
+        return -1;
+    }
+    unsigned idx = take_slot();
+    struct slot *s = &slots[idx];
+    memcpy(s->buf, rec, len);
+    s->len = len;
+    s->off = (off_t)atomic_fetch_add(&next_off, len);
+    s->submitted_ns = now_ns();
+
+    if (active == ASYNC_URING) {
+        if (uring_submit(IORING_OP_WRITE, s, idx) != 0) {
+            finish_write(s, 0);
+            put_slots(&idx, 1);
+        }
+    } else {
+        pool_submit(idx);
+    }
+    return 0;
+}
+
+void async_out_close(unsigned long *writes, unsigned long *batches) {
+    /* Holding every slot means no write is still in flight */
+    for (unsigned i = 0; i < nslots; i++) {
+        take_slot();
+    }
+
+    if (active == ASYNC_URING) {
+        /* A reaper that gave up has already exited */
+        uring_submit(IORING_OP_NOP, NULL, STOP_TAG);
+        pthread_join(reaper, NULL);
+        uring_teardown();
+        free(reaped);
+    } else {
+        pthread_mutex_lock(&queue_lock);
+        pool_stop = 1;
+        pthread_cond_broadcast(&queue_cond);
+        pthread_mutex_unlock(&queue_lock);
+        for (int i = 0; i < POOL_THREADS; i++) {
+            pthread_join(pool[i], NULL);
+        }
+        free(queue);
+    }
+
+    close(out_fd);
+    sem_destroy(&free_count);
+    free(free_stack);
+    free(slot_bufs);
+    free(slots);
+    *writes = atomic_load(&completed);
+    *batches = atomic_load(&reaped_batches);
+}
+
+const char *async_out_backend(void) {
+    return active == ASYNC_URING ? "io_uring" : "thread pool";
+}
+
+const struct hist *async_out_latency(void) {
+    return &write_latency;
+}
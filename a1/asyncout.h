@@ -0,0 +1,59 @@
+#ifndef ASYNCOUT_H
+#define ASYNCOUT_H
+
+#include <stddef.h>
+#include "hist.h"
+
+/*
+ * Asynchronous appends to the output file.
+ *
+ * A writer reserves its byte range with an atomic fetch-add on the end
+ * offset, copies its record into a free in-flight buffer and submits a
+ * positioned write; it never waits for the write itself. Completions are
+ * reaped in batches by a background thread, which recycles the buffers.
+ *
+ * The io_uring backend talks to the kernel directly (no liburing). Where
+ * io_uring is unavailable or lacks IORING_OP_WRITE, or with ASYNC_POOL, a
+ * small pool of threads issues the pwrite() calls instead. A write the
+ * ring fails is retried with pwrite(), and if the ring stops delivering
+ * completions altogether, writers fall back to synchronous pwrite().
+ */
+
+enum async_backend {
+    ASYNC_URING,  /* io_uring, falling back to ASYNC_POOL if setup fails */
+    ASYNC_POOL    /* Worker threads calling pwrite() */
+};
+
+/*
+ * Opens path (which must exist) for appending after its current contents.
+ * @param path    Output file
+ * @param backend Preferred backend
+ * @param depth   Writes that may be in flight at once; writers wait for a
+ *                free buffer beyond that
+ * @param rec_max Largest record that will be appended
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int async_out_init(const char *path, enum async_backend backend,
+                   unsigned depth, size_t rec_max);
+
+/*
+ * Queues one record for writing at a freshly reserved offset.
+ * @return 0 on success, -1 if rec is longer than rec_max
+ */
+int async_out_append(const char *rec, size_t len);
+
+/*
+ * Call once every writer has finished: waits for all outstanding writes,
+ * stops the reaper and closes the file.
+ * @param writes  Set to the number of write operations completed
+ * @param batches Set to the number of completion batches reaped
+ */
+void async_out_close(unsigned long *writes, unsigned long *batches);
+
+/* The backend actually in use, e.g. "io_uring" or "thread pool" */
+const char *async_out_backend(void);
+
+/* Submission-to-completion time of each write */
+const struct hist *async_out_latency(void);
+
+#endif /* ASYNCOUT_H */
@@ -1,14 +1,101 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/resource.h>
 #include <semaphore.h>
 #include <pthread.h>
 #include "bots.h"
+#include "asyncout.h"
+#include "hist.h"
+#include "lockstat.h"
+#include "mmapout.h"
+#include "ringlog.h"
+#include "sched.h"
 
 /* Global semaphore used to synchronize access to the shared file */
 sem_t flag;
 
+/* Settings from the command line; defaults reproduce the original program */
+struct bot_config config = { WRITE_SEM, PERIOD_DEFAULT, SCHED_THREADS, NUM_THREADS,
+                             DURABLE_NONE, 0, NUM_ITER, 0, OUTPUT_FILE, 0 };
+
+/* Ring slots for WRITE_RING: enough that bots rarely wait on the writer */
+#define RING_SLOTS 4096
+/* WRITE_MMAP grows the file this much at a time */
+#define MMAP_CHUNK (64 << 20)
+
+/* WRITE_COMMIT with -d periodic syncs this often */
+#define SYNC_PERIOD_MS 100
+/* WRITE_URING/WRITE_POOL: writes in flight before bots have to wait */
+#define ASYNC_DEPTH 256
+
+/* -w names, indexed by enum write_mode */
+static const char *write_mode_names[] = { "sem", "ring", "mmap", "commit",
+                                           "uring", "pool" };
+/* -d names, indexed by enum durability */
+static const char *durability_names[] = { "none", "periodic", "group" };
+
+/*
+ * Looks name up in a table of option names.
+ * @return Its index, or -1 if it isn't there
+ */
+static int lookup(const char *name, const char *const names[], size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Parses a whole decimal number for a command-line option, exiting with
+ * a message if it is malformed or outside min..max.
+ * @param what Description of the value for the message, e.g. "bot count"
+ */
+static int parse_number(const char *arg, const char *what, long min, long max) {
+    char *end;
+    errno = 0;
+    long v = strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || errno == ERANGE || v < min || v > max) {
+        fprintf(stderr, "invalid %s '%s' (must be %ld..%ld)\n", what, arg, min, max);
+        exit(EXIT_FAILURE);
+    }
+    return (int)v;
+}
+
+/* When the bots were started and the CPU used so far, for the reports */
+static uint64_t start_ns;
+static struct rusage start_usage;
+
+/*
+ * What each bot has done, indexed by ID; only that bot writes its entry.
+ * Each entry has a cache line to itself, so bots running on different
+ * cores don't keep stealing the line from each other.
+ */
+struct bot_stats {
+    _Alignas(64) unsigned long writes;
+    unsigned long bytes;
+    uint64_t finished_ns;   /* When its last write returned */
+};
+static struct bot_stats *bot_stats;
+
+/*
+ * How long each bot_step() kept its bot from moving on, in any mode.
+ * Threads record into a histogram of their own, so timing doesn't put a
+ * shared cache line on every write; each is merged in as its thread exits.
+ */
+static struct hist append_latency;
+static pthread_mutex_t latency_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t latency_key;
+static _Thread_local struct hist *my_latency;
+
 /* Two sample quotes: one for even threads, one for odd threads */
 static const char *quote_even =
     "\"Controlling complexity is the essence of computer programming.\" --Brian Kernighan";
@@ -16,41 +103,185 @@ static const char *quote_even =
 static const char *quote_odd =
     "\"Computer science is no more about computers than astronomy is about telescopes.\" --Edsger Dijkstra";
 
+/*
+ * Logs that bot tid wrote a record (not in benchmark mode).
+ */
+static void log_running(int tid) {
+    if (!config.bench) {
+        printf("Thread %d is running\n", tid);
+    }
+}
+
+/*
+ * Appends one record the original way: open, write and close the file
+ * while holding the semaphore, then log to stdout. With -c, the time
+ * spent waiting for and holding the semaphore is recorded.
+ */
+static void write_record_sem(int tid, const char *rec) {
+    uint64_t asked = config.lock_stats ? now_ns() : 0;
+
+    /* Acquire semaphore before file access */
+    sem_wait(&flag);
+    uint64_t acquired = config.lock_stats ? now_ns() : 0;
+
+    /* Open file in append mode */
+    FILE *f = fopen(config.output, "a");
+    if (f) {
+        fputs(rec, f);
+        fclose(f);
+    } else {
+        perror("fopen");  /* Report file open errors */
+    }
+
+    /* Log thread activity to console */
+    log_running(tid);
+
+    /* Release semaphore after file access */
+    if (config.lock_stats) {
+        lockstat_record(acquired - asked, now_ns() - acquired);
+    }
+    sem_post(&flag);
+}
+
+/*
+ * Pause before each of a bot's writes: -p if given (0 with -n),
+ * otherwise even IDs wait 2s and odd IDs 3s.
+ */
+static unsigned bot_period_ms(int tid) {
+    if (config.period_ms != PERIOD_DEFAULT) {
+        return (unsigned)config.period_ms;
+    }
+    return (tid % 2 == 0) ? 2000 : 3000;
+}
+
+/* Buffer size a record needs, NUL included */
+static size_t record_capacity(void) {
+    return config.record_size ? (size_t)config.record_size + 1 : RECORD_MAX;
+}
+
+/*
+ * Formats bot tid's record into rec: its ID and the quote for its parity,
+ * ending in CRLF. With -r the quote is repeated or cut so the record is
+ * exactly config.record_size bytes.
+ * @return Record length
+ */
+static size_t format_record(int tid, char *rec, size_t cap) {
+    const char *quote = (tid % 2 == 0) ? quote_even : quote_odd;
+    if (config.record_size == 0) {
+        int len = snprintf(rec, cap, "Thread ID %d: %s\r\n", tid, quote);
+        return len >= (int)cap ? cap - 1 : (size_t)len;
+    }
+
+    size_t body = (size_t)config.record_size - 2;   /* Room before CRLF */
+    int head = snprintf(rec, body + 1, "Thread ID %d: ", tid);
+    size_t len = head >= (int)(body + 1) ? body : (size_t)head;
+    size_t qlen = strlen(quote);
+    while (len < body) {
+        size_t n = body - len < qlen ? body - len : qlen;
+        memcpy(rec + len, quote, n);
+        len += n;
+        if (len < body) {
+            rec[len++] = ' ';
+        }
+    }
+    memcpy(rec + len, "\r\n", 3);
+    return len + 2;
+}
+
+/*
+ * Key destructor: folds an exiting thread's append latencies into the total.
+ */
+static void merge_latency(void *arg) {
+    pthread_mutex_lock(&latency_lock);
+    hist_merge(&append_latency, arg);
+    pthread_mutex_unlock(&latency_lock);
+    free(arg);
+}
+
+/*
+ * Records one append latency in the calling thread's histogram.
+ */
+static void record_latency(uint64_t ns) {
+    if (!my_latency) {
+        my_latency = malloc(sizeof(*my_latency));
+        if (!my_latency) {
+            return;
+        }
+        hist_init(my_latency);
+        pthread_setspecific(latency_key, my_latency);
+    }
+    hist_add(my_latency, ns);
+}
+
+/*
+ * One write by bot tid: formats its ID and quote, then appends it
+ * through the configured write path and logs to stdout.
+ */
+static void bot_step(int tid) {
+    char rec[RECORD_LIMIT + 1];
+    size_t len = format_record(tid, rec, record_capacity());
+
+    uint64_t start = now_ns();
+    switch (config.mode) {
+    case WRITE_RING:
+        /* No lock: the writer thread does the file I/O */
+        ring_push(rec, len);
+        log_running(tid);
+        break;
+    case WRITE_COMMIT:
+        /* Blocks until the record is as durable as -d asks for */
+        if (durable_append(rec, len) != 0) {
+            perror("durable_append");
+        }
+        log_running(tid);
+        break;
+    case WRITE_MMAP:
+        /* No lock: copy straight into the mapped file */
+        if (mmap_out_append(rec, len) != 0) {
+            perror("mmap_out_append");
+        }
+        log_running(tid);
+        break;
+    case WRITE_URING:
+    case WRITE_POOL:
+        /* Returns once the write is queued, not when it's done */
+        if (async_out_append(rec, len) != 0) {
+            perror("async_out_append");
+        }
+        log_running(tid);
+        break;
+    default:
+        write_record_sem(tid, rec);
+        break;
+    }
+    uint64_t end = now_ns();
+    record_latency(end - start);
+
+    struct bot_stats *bs = &bot_stats[tid];
+    bs->writes++;
+    bs->bytes += len;
+    bs->finished_ns = end;
+}
+
 /*
  * The function executed by each bot thread.
- * It sleeps, acquires the semaphore, appends its ID and quote to the file,
- * logs to stdout, then releases the semaphore. Repeats NUM_ITER times.
+ * It sleeps, then appends its ID and quote to the file through the
+ * configured write path and logs to stdout. Repeats config.iters times.
  */
 void *bot_thread(void *arg) {
     struct thread_data *td = arg;
     int tid = td->id;
 
-    for (int i = 0; i < NUM_ITER; i++) {
-        /* Sleep interval: even threads wait 2s, odd threads 3s */
-        sleep((tid % 2 == 0) ? 2 : 3);
-
-        /* Acquire semaphore before file access */
-        sem_wait(&flag);
-
-        /* Open file in append mode */
-        FILE *f = fopen("QUOTE.txt", "a");
-        if (f) {
-            /* Write thread ID and appropriate quote */
-            if (tid % 2 == 0) {
-                fprintf(f, "Thread ID %d: %s\r\n", tid, quote_even);
-            } else {
-                fprintf(f, "Thread ID %d: %s\r\n", tid, quote_odd);
+    for (int i = 0; i < config.iters; i++) {
+        /* Sleep interval: even threads wait 2s, odd threads 3s, unless -p/-n */
+        unsigned period = bot_period_ms(tid);
+        if (period > 0) {
+            struct timespec pause = { period / 1000, (period % 1000) * 1000000L };
+            while (nanosleep(&pause, &pause) != 0) {
+                /* Interrupted: sleep for what's left */
             }
-            fclose(f);
-        } else {
-            perror("fopen");  /* Report file open errors */
         }
-
-        /* Log thread activity to console */
-        printf("Thread %d is running\n", tid);
-
-        /* Release semaphore after file access */
-        sem_post(&flag);
+        bot_step(tid);
     }
 
     free(td);  /* Free the thread-specific data */
@@ -59,11 +290,11 @@ void *bot_thread(void *arg) {
 
 /*
  * Initializes the shared output file:
- * - Creates or truncates "QUOTES.txt"
+ * - Creates or truncates config.output ("QUOTE.txt" by default)
  * - Writes the current process ID
  */
 void init_file() {
-    FILE *f = fopen("QUOTE.txt", "w");
+    FILE *f = fopen(config.output, "w");
     if (!f) {
         perror("fopen");
         exit(EXIT_FAILURE);
@@ -73,22 +304,67 @@ void init_file() {
 }
 
 /*
- * Initializes the unnamed semaphore 'flag' to 1
+ * Sets up the selected write path (writer threads, file mapping or ring).
+ * Must run after init_file() so the output file exists.
+ */
+void init_writer() {
+    if (config.mode == WRITE_RING &&
+        ring_init(config.output, RING_SLOTS, record_capacity()) != 0) {
+        perror("ring_init");
+        exit(EXIT_FAILURE);
+    }
+    if (config.mode == WRITE_MMAP && mmap_out_init(config.output, MMAP_CHUNK) != 0) {
+        perror("mmap_out_init");
+        exit(EXIT_FAILURE);
+    }
+    if (config.mode == WRITE_COMMIT &&
+        durable_init(config.output, config.durability, SYNC_PERIOD_MS) != 0) {
+        perror("durable_init");
+        exit(EXIT_FAILURE);
+    }
+    if ((config.mode == WRITE_URING || config.mode == WRITE_POOL) &&
+        async_out_init(config.output, config.mode == WRITE_URING ? ASYNC_URING : ASYNC_POOL,
+                       ASYNC_DEPTH, record_capacity()) != 0) {
+        perror("async_out_init");
+        exit(EXIT_FAILURE);
+    }
+    hist_init(&append_latency);
+    if (pthread_key_create(&latency_key, merge_latency) != 0) {
+        perror("pthread_key_create");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t stats_len = ((size_t)config.bots + 1) * sizeof(*bot_stats);
+    bot_stats = aligned_alloc(_Alignof(struct bot_stats), stats_len);
+    if (!bot_stats) {
+        perror("aligned_alloc");
+        exit(EXIT_FAILURE);
+    }
+    memset(bot_stats, 0, stats_len);
+}
+
+/*
+ * Initializes the unnamed semaphore 'flag' to 1 (and its statistics, with -c)
  */
 void init_semaphore() {
     if (sem_init(&flag, 0, 1) != 0) {
         perror("sem_init");
         exit(EXIT_FAILURE);
     }
+    if (config.lock_stats) {
+        lockstat_init();
+    }
 }
 
 /*
- * Creates NUM_THREADS threads, printing a creation message for each,
+ * Creates config.bots threads, printing a creation message for each,
  * and passing a unique ID via dynamically-allocated data.
  */
 void create_threads(pthread_t threads[]) {
-    for (int i = 0; i < NUM_THREADS; i++) {
-        printf("Creating thread %d in main()\n", i + 1);
+    for (int i = 0; i < config.bots; i++) {
+        if (!config.bench) {
+            printf("Creating thread %d in main()\n", i + 1);
+        }
         struct thread_data *td = malloc(sizeof(*td));
         td->id = i + 1;
         if (pthread_create(&threads[i], NULL, bot_thread, td) != 0) {
@@ -102,34 +378,245 @@ void create_threads(pthread_t threads[]) {
  * Waits (joins) for all threads to complete execution.
  */
 void wait_for_threads(pthread_t threads[]) {
-    for (int i = 0; i < NUM_THREADS; i++) {
+    for (int i = 0; i < config.bots; i++) {
         pthread_join(threads[i], NULL);
     }
 }
 
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double tv_seconds(struct timeval tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/*
+ * Benchmark report (-b): the run's settings, byte throughput, how evenly
+ * the bots were served and the CPU time the whole process used.
+ * Fairness compares each bot's own write rate (its writes over the time
+ * it took to finish them); Jain's index is 1.0 when every bot got the
+ * same rate and 1/n when one bot got everything.
+ */
+static void bench_report(double secs) {
+    struct rusage end_usage;
+    getrusage(RUSAGE_SELF, &end_usage);
+
+    uint64_t *took = malloc((size_t)config.bots * sizeof(*took));
+    if (!took) {
+        perror("malloc");
+        return;
+    }
+    unsigned long bytes = 0, min_writes = 0, max_writes = 0;
+    double rate_sum = 0, rate_sq = 0;
+    for (int id = 1; id <= config.bots; id++) {
+        const struct bot_stats *bs = &bot_stats[id];
+        took[id - 1] = bs->finished_ns > start_ns ? bs->finished_ns - start_ns : 0;
+        double rate = took[id - 1] ? bs->writes / (took[id - 1] / 1e9) : 0.0;
+        rate_sum += rate;
+        rate_sq += rate * rate;
+        bytes += bs->bytes;
+        if (id == 1 || bs->writes < min_writes) min_writes = bs->writes;
+        if (id == 1 || bs->writes > max_writes) max_writes = bs->writes;
+    }
+    qsort(took, config.bots, sizeof(*took), compare_u64);
+
+    char pacing[32];
+    if (config.period_ms == PERIOD_DEFAULT) {
+        snprintf(pacing, sizeof(pacing), "2 s / 3 s");
+    } else if (config.period_ms == 0) {
+        snprintf(pacing, sizeof(pacing), "none (saturation)");
+    } else {
+        snprintf(pacing, sizeof(pacing), "%d ms", config.period_ms);
+    }
+    double user = tv_seconds(end_usage.ru_utime) - tv_seconds(start_usage.ru_utime);
+    double sys = tv_seconds(end_usage.ru_stime) - tv_seconds(start_usage.ru_stime);
+    long records = (long)config.bots * config.iters;
+
+    printf("benchmark: %d bots x %d writes, %s records, pacing %s, output %s\n",
+           config.bots, config.iters,
+           config.record_size ? "fixed-size" : "quote", pacing, config.output);
+    printf("  throughput: %.0f records/sec, %.2f MB/s (%lu bytes)\n",
+           secs > 0 ? records / secs : 0.0, secs > 0 ? bytes / secs / 1e6 : 0.0, bytes);
+    printf("  fairness: writes per bot %lu to %lu; finish time min %.1f ms, median %.1f ms,"
+           " max %.1f ms; Jain's index %.3f\n",
+           min_writes, max_writes, took[0] / 1e6, took[config.bots / 2] / 1e6,
+           took[config.bots - 1] / 1e6,
+           rate_sq > 0 ? rate_sum * rate_sum / (config.bots * rate_sq) : 1.0);
+    printf("  cpu: user %.3f s, sys %.3f s, %.2f us/record, %.0f%% of one core;"
+           " context switches %ld voluntary, %ld involuntary\n",
+           user, sys, records ? (user + sys) * 1e6 / records : 0.0,
+           secs > 0 ? 100.0 * (user + sys) / secs : 0.0,
+           end_usage.ru_nvcsw - start_usage.ru_nvcsw,
+           end_usage.ru_nivcsw - start_usage.ru_nivcsw);
+    free(took);
+}
+
 /*
  * Cleans up resources:
+ * - Drains and stops the ring writer, unmaps and truncates the mapped
+ *   file to its exact length, syncs the durable log, or waits for
+ *   outstanding asynchronous writes, if used
  * - Destroys the semaphore
- * - Prints a final goodbye message
+ * - Reports write throughput and latency, semaphore contention with -c,
+ *   the benchmark report with -b, and prints a final goodbye message
  */
 void cleanup() {
+    unsigned long writes = (unsigned long)config.bots * config.iters;  /* one open/write/close each */
+    if (config.mode == WRITE_RING) {
+        writes = ring_shutdown();
+    } else if (config.mode == WRITE_MMAP) {
+        mmap_out_close();
+        writes = 0;  /* Only page faults and the final truncate */
+    }
+    unsigned long syncs = 0, batches = 0;
+    if (config.mode == WRITE_COMMIT) {
+        if (durable_close(&writes, &syncs) != 0) {
+            perror("durable log");
+        }
+    } else if (config.mode == WRITE_URING || config.mode == WRITE_POOL) {
+        async_out_close(&writes, &batches);
+    }
     sem_destroy(&flag);
+
+    double secs = (now_ns() - start_ns) / 1e9;
+    long records = (long)config.bots * config.iters;
+    printf("%s mode, %s scheduler: %ld records in %.3f s (%.0f records/sec, %lu file writes)\n",
+           write_mode_names[config.mode],
+           config.sched == SCHED_WHEEL ? "wheel" : "thread", records, secs,
+           secs > 0 ? records / secs : 0.0, writes);
+    if (config.mode == WRITE_COMMIT) {
+        printf("durability %s: %lu fdatasync calls\n",
+               durability_names[config.durability], syncs);
+        hist_print(stdout, "commit latency", durable_latency());
+    }
+    if (config.mode == WRITE_URING || config.mode == WRITE_POOL) {
+        printf("%s backend: completions reaped in %lu batches\n",
+               async_out_backend(), batches);
+        hist_print(stdout, "write latency", async_out_latency());
+    }
+    hist_print(stdout, "append latency", &append_latency);
+    if (config.lock_stats && config.mode == WRITE_SEM) {
+        lockstat_report(stdout, secs);
+    }
+    if (config.bench) {
+        bench_report(secs);
+    }
+    free(bot_stats);
     printf("All bots finished, Goodbye!.\n");
 }
 
+/*
+ * Parses command-line options into config:
+ *   -w sem|ring|mmap|commit|uring|pool  output path (default sem)
+ *   -d none|periodic|group     durability for -w commit (default none)
+ *   -c                         report semaphore contention (-w sem)
+ *   -p ms                      pause before every write (default 2 s even / 3 s odd)
+ *   -n                         no sleeping between writes (-p 0)
+ *   -s threads|wheel           one thread per bot, or timer wheel + worker pool
+ *   -t count                   number of bots (default NUM_THREADS)
+ *   -i count                   writes per bot (default NUM_ITER)
+ *   -r bytes                   exact record size, 2..RECORD_LIMIT (default ID + quote)
+ *   -o path                    output file (default OUTPUT_FILE)
+ *   -b                         benchmark: no per-write output, extra report
+ */
+void parse_args(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "w:d:cp:ns:t:i:r:o:b")) != -1) {
+        switch (opt) {
+        case 'w': {
+            int m = lookup(optarg, write_mode_names,
+                           sizeof(write_mode_names) / sizeof(*write_mode_names));
+            if (m < 0) {
+                fprintf(stderr, "unknown write mode '%s'\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            config.mode = (enum write_mode)m;
+            break;
+        }
+        case 'd': {
+            int d = lookup(optarg, durability_names,
+                           sizeof(durability_names) / sizeof(*durability_names));
+            if (d < 0) {
+                fprintf(stderr, "unknown durability '%s'\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            config.durability = (enum durability)d;
+            break;
+        }
+        case 'c':
+            config.lock_stats = 1;
+            break;
+        case 'p':
+            config.period_ms = parse_number(optarg, "pause", 0, INT_MAX);
+            break;
+        case 'n':
+            config.period_ms = 0;
+            break;
+        case 's':
+            if (strcmp(optarg, "threads") == 0) {
+                config.sched = SCHED_THREADS;
+            } else if (strcmp(optarg, "wheel") == 0) {
+                config.sched = SCHED_WHEEL;
+            } else {
+                fprintf(stderr, "unknown scheduler '%s'\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 't':
+            config.bots = parse_number(optarg, "bot count", 1, INT_MAX - 1);
+            break;
+        case 'i':
+            config.iters = parse_number(optarg, "write count", 1, INT_MAX);
+            break;
+        case 'r':
+            config.record_size = parse_number(optarg, "record size", 2, RECORD_LIMIT);
+            break;
+        case 'o':
+            config.output = optarg;
+            break;
+        case 'b':
+            config.bench = 1;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-w sem|ring|mmap|commit|uring|pool] [-d none|periodic|group] [-c]"
+                    " [-p ms | -n] [-s threads|wheel] [-t count] [-i count] [-r bytes]"
+                    " [-o path] [-b]\n",
+                    argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
 /*
  * Main entry point:
- * - Initializes file and semaphore
+ * - Parses options
+ * - Initializes file, semaphore and writer
  * - Creates and waits for threads
  * - Performs cleanup
  */
-int main(void) {
-    pthread_t threads[NUM_THREADS];
-
+int main(int argc, char *argv[]) {
+    parse_args(argc, argv);
     init_file();         /* Create/truncate file and write PID */
     init_semaphore();    /* Setup semaphore */
-    create_threads(threads);
-    wait_for_threads(threads);
+    init_writer();       /* Start ring writer / map file if selected */
+    getrusage(RUSAGE_SELF, &start_usage);
+    start_ns = now_ns();
+
+    if (config.sched == SCHED_WHEEL) {
+        /* Bots are tasks on a per-core pool rather than threads */
+        wheel_run(config.bots, config.iters, 0, bot_step, bot_period_ms);
+    } else {
+        pthread_t *threads = malloc(config.bots * sizeof(*threads));
+        if (!threads) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        create_threads(threads);
+        wait_for_threads(threads);
+        free(threads);
+    }
     cleanup();           /* Destroy semaphore and print exit */
 
     return EXIT_SUCCESS;
@@ -3,15 +3,61 @@
 
 #include <semaphore.h>  /* POSIX semaphore support */
 #include <pthread.h>    /* POSIX threads support */
+#include "durable.h"    /* enum durability */
 
-/* Number of bot threads to spawn */
+/* Default number of bots (-t) */
 #define NUM_THREADS 7
-/* Number of times each thread writes its quote */
+/* Default number of times each bot writes its quote (-i) */
 #define NUM_ITER    8
+/* Default shared output file (-o) */
+#define OUTPUT_FILE "QUOTE.txt"
+/* Largest record a bot writes by default (thread ID prefix + quote + CRLF) */
+#define RECORD_MAX  256
+/* Largest record size -r accepts */
+#define RECORD_LIMIT 65536
+/* Pacing value meaning the original 2 s (even) / 3 s (odd) schedule */
+#define PERIOD_DEFAULT (-1)
+
+/*
+ * How bots append their record to the output file.
+ */
+enum write_mode {
+    WRITE_SEM,   /* fopen/fprintf/fclose while holding the semaphore (default) */
+    WRITE_RING,  /* lock-free ring drained by one writer thread (ringlog.c) */
+    WRITE_MMAP,  /* memcpy into a mapped file at an atomically reserved offset (mmapout.c) */
+    WRITE_COMMIT, /* write() to an open fd with a chosen durability level (durable.c) */
+    WRITE_URING, /* Asynchronous io_uring writes at reserved offsets (asyncout.c) */
+    WRITE_POOL   /* The same, with a pwrite() thread pool instead of io_uring */
+};
+
+/*
+ * How bots are mapped onto threads.
+ */
+enum sched_mode {
+    SCHED_THREADS,  /* One pthread per bot, sleeping between writes (default) */
+    SCHED_WHEEL     /* Timer wheel feeding a per-core worker pool (sched.c) */
+};
+
+/*
+ * Run-time settings, filled in from the command line by main().
+ */
+struct bot_config {
+    enum write_mode mode;   /* Output path (-w) */
+    int period_ms;          /* Pause before each write (-p; -n for 0), or PERIOD_DEFAULT */
+    enum sched_mode sched;  /* Threading model (-s) */
+    int bots;               /* Number of bots (-t), NUM_THREADS by default */
+    enum durability durability;  /* Sync policy for WRITE_COMMIT (-d) */
+    int lock_stats;         /* Time semaphore waits and holds in WRITE_SEM (-c) */
+    int iters;              /* Writes per bot (-i), NUM_ITER by default */
+    int record_size;        /* Exact bytes per record (-r), or 0 for ID + quote */
+    const char *output;     /* Output file (-o), OUTPUT_FILE by default */
+    int bench;              /* Quiet run with a benchmark report (-b) */
+};
+extern struct bot_config config;
 
 /*
  * Global semaphore used by threads to synchronize access
- * to the shared output file QUOTES.txt.
+ * to the shared output file (QUOTE.txt by default).
  */
 extern sem_t flag;
 
@@ -20,14 +66,14 @@ extern sem_t flag;
  * thread_data containing the unique thread ID.
  */
 struct thread_data {
-    int id;  /* Unique thread identifier (1..NUM_THREADS) */
+    int id;  /* Unique thread identifier (1..config.bots) */
 };
 
 /*
  * Thread entry point. Each bot thread runs this function,
  * writing to the shared file and logging to stdout.
  * @param arg Pointer to a dynamically-allocated thread_data
- * @return NULL (threads exit after completing NUM_ITER iterations)
+ * @return NULL (threads exit after completing config.iters iterations)
  */
 void *bot_thread(void *arg);
 
@@ -0,0 +1,246 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "durable.h"
+
+static int log_fd = -1;
+static enum durability log_level;
+static unsigned sync_period_ms;
+static struct hist commit_latency;
+static atomic_ulong write_calls;
+static atomic_ulong sync_calls;
+/* errno of the first failed write() or fdatasync(), or 0. Once set, no
+ * later record can be promised durable, so every append fails with it */
+static atomic_int log_error;
+
+/* DURABLE_PERIODIC: background syncer */
+static pthread_t syncer;
+static pthread_mutex_t syncer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t syncer_cond = PTHREAD_COND_INITIALIZER;
+static int syncer_stop;
+
+/*
+ * DURABLE_GROUP state, all under group_lock. Appenders add their record
+ * to the filling batch and take a ticket. Whoever finds no flush in
+ * progress becomes the leader: it takes the whole batch, writes and syncs
+ * it outside the lock, then releases every follower whose ticket it
+ * covered, telling them whether the flush worked. Records arriving
+ * meanwhile form the next batch.
+ */
+static pthread_mutex_t group_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t group_cond = PTHREAD_COND_INITIALIZER;
+static char *batch, *spare;            /* Filling batch and the leader's spare */
+static size_t batch_len, batch_cap, spare_cap;
+static uint64_t appended;              /* Tickets handed out */
+static uint64_t durable;               /* Highest ticket on stable storage */
+static uint64_t resolved;              /* Highest ticket flushed, or failed */
+static int flushing;                   /* A leader is writing/syncing */
+
+/*
+ * Remembers the first failure; see log_error.
+ */
+static void set_error(int err) {
+    int none = 0;
+    atomic_compare_exchange_strong(&log_error, &none, err);
+}
+
+/*
+ * Writes the whole buffer, resuming after short writes.
+ * @return 0 on success, -1 on failure (errno set and recorded)
+ */
+static int write_all(const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(log_fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            set_error(errno);
+            return -1;
+        }
+        atomic_fetch_add_explicit(&write_calls, 1, memory_order_relaxed);
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*
+ * fdatasync()s the log. A failed sync may have dropped dirty pages, so
+ * retrying can't make the lost records durable; it is recorded instead.
+ * @return 0 on success, -1 on failure (errno set and recorded)
+ */
+static int sync_file(void) {
+    int rc = fdatasync(log_fd);
+    if (rc != 0) {
+        set_error(errno);
+    }
+    atomic_fetch_add_explicit(&sync_calls, 1, memory_order_relaxed);
+    return rc;
+}
+
+/*
+ * DURABLE_PERIODIC: fdatasync() every sync_period_ms until told to stop.
+ */
+static void *syncer_thread(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&syncer_lock);
+    while (!syncer_stop) {
+        struct timespec wake;
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_sec += sync_period_ms / 1000;
+        wake.tv_nsec += (sync_period_ms % 1000) * 1000000L;
+        if (wake.tv_nsec >= 1000000000L) {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&syncer_cond, &syncer_lock, &wake);
+        pthread_mutex_unlock(&syncer_lock);
+        sync_file();
+        pthread_mutex_lock(&syncer_lock);
+    }
+    pthread_mutex_unlock(&syncer_lock);
+    return NULL;
+}
+
+/*
+ * DURABLE_GROUP: append under group_lock, then lead or follow a flush
+ * until our ticket's flush has finished.
+ * @return 0 if the record is durable, -1 if its flush failed
+ */
+static int group_append(const char *rec, size_t len) {
+    pthread_mutex_lock(&group_lock);
+    if (batch_len + len > batch_cap) {
+        size_t cap = batch_cap ? batch_cap : 4096;
+        while (cap < batch_len + len) {
+            cap *= 2;
+        }
+        char *grown = realloc(batch, cap);
+        if (!grown) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+        batch = grown;
+        batch_cap = cap;
+    }
+    memcpy(batch + batch_len, rec, len);
+    batch_len += len;
+    uint64_t ticket = ++appended;
+
+    while (resolved < ticket) {
+        if (flushing) {
+            pthread_cond_wait(&group_cond, &group_lock);
+            continue;
+        }
+
+        /* Lead: take the batch and leave an empty one for the next group */
+        flushing = 1;
+        char *buf = batch;
+        size_t buf_len = batch_len;
+        size_t buf_cap = batch_cap;
+        uint64_t covers = appended;
+        batch = spare;
+        batch_cap = spare_cap;
+        batch_len = 0;
+        pthread_mutex_unlock(&group_lock);
+
+        int ok = write_all(buf, buf_len) == 0 && sync_file() == 0;
+
+        pthread_mutex_lock(&group_lock);
+        spare = buf;
+        spare_cap = buf_cap;
+        if (ok && atomic_load(&log_error) == 0) {
+            durable = covers;
+        }
+        resolved = covers;
+        flushing = 0;
+        pthread_cond_broadcast(&group_cond);
+    }
+    int rc = durable >= ticket ? 0 : -1;
+    pthread_mutex_unlock(&group_lock);
+    return rc;
+}
+
+int durable_init(const char *path, enum durability level, unsigned period_ms) {
+    log_level = level;
+    sync_period_ms = period_ms;
+    hist_init(&commit_latency);
+    atomic_init(&write_calls, 0);
+    atomic_init(&sync_calls, 0);
+    atomic_init(&log_error, 0);
+    appended = durable = resolved = 0;
+
+    log_fd = open(path, O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (log_fd < 0) {
+        return -1;
+    }
+    if (level == DURABLE_PERIODIC) {
+        syncer_stop = 0;
+        errno = pthread_create(&syncer, NULL, syncer_thread, NULL);
+        if (errno) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int durable_append(const char *rec, size_t len) {
+    int err = atomic_load(&log_error);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+
+    uint64_t start = now_ns();
+    int rc;
+    if (log_level == DURABLE_GROUP) {
+        rc = group_append(rec, len);
+    } else {
+        /* O_APPEND makes each single write() an atomic append */
+        rc = write_all(rec, len);
+    }
+    hist_add(&commit_latency, now_ns() - start);
+    if (rc != 0) {
+        errno = atomic_load(&log_error);
+    }
+    return rc;
+}
+
+int durable_close(unsigned long *writes, unsigned long *syncs) {
+    if (log_level == DURABLE_PERIODIC) {
+        pthread_mutex_lock(&syncer_lock);
+        syncer_stop = 1;
+        pthread_cond_signal(&syncer_cond);
+        pthread_mutex_unlock(&syncer_lock);
+        pthread_join(syncer, NULL);
+    }
+    if (log_level != DURABLE_NONE) {
+        sync_file();
+    }
+    close(log_fd);
+    log_fd = -1;
+    free(batch);
+    free(spare);
+    batch = spare = NULL;
+    batch_cap = spare_cap = 0;
+
+    *writes = atomic_load(&write_calls);
+    *syncs = atomic_load(&sync_calls);
+    int err = atomic_load(&log_error);
+    if (err) {
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+const struct hist *durable_latency(void) {
+    return &commit_latency;
+}
@@ -0,0 +1,47 @@
+#ifndef DURABLE_H
+#define DURABLE_H
+
+#include <stddef.h>
+#include "hist.h"
+
+/*
+ * Durable append log with selectable durability.
+ */
+enum durability {
+    DURABLE_NONE,      /* write() only; durable whenever the kernel gets to it */
+    DURABLE_PERIODIC,  /* write(), plus a background fdatasync() every period */
+    DURABLE_GROUP      /* Group commit: concurrent appends share one fdatasync()
+                        * and each caller returns once its record is durable */
+};
+
+/*
+ * Opens path (which must exist) for appending.
+ * @param path      Output file
+ * @param level     Durability level
+ * @param period_ms fdatasync interval for DURABLE_PERIODIC
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int durable_init(const char *path, enum durability level, unsigned period_ms);
+
+/*
+ * Appends one record. Returns once it has been written (NONE, PERIODIC)
+ * or is on stable storage (GROUP). The time spent here is recorded in
+ * the commit latency histogram.
+ * @return 0 on success, -1 (errno set) if the record could not be
+ *         written or synced. After any write or sync failure, including
+ *         a background sync's, every later append fails too
+ */
+int durable_append(const char *rec, size_t len);
+
+/*
+ * Call once every writer has finished: syncs and closes the file.
+ * @param writes Set to the number of write() calls made
+ * @param syncs  Set to the number of fdatasync() calls made
+ * @return 0, or -1 (errno set) if any write or sync failed
+ */
+int durable_close(unsigned long *writes, unsigned long *syncs);
+
+/* Commit latency of every durable_append() call so far */
+const struct hist *durable_latency(void);
+
+#endif /* DURABLE_H */
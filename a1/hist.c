@@ -0,0 +1,78 @@
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include "hist.h"
+
+uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+void hist_init(struct hist *h) {
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        atomic_init(&h->count[b], 0);
+    }
+    atomic_init(&h->n, 0);
+    atomic_init(&h->sum_ns, 0);
+    atomic_init(&h->max_ns, 0);
+}
+
+void hist_add(struct hist *h, uint64_t ns) {
+    int b = ns ? 64 - __builtin_clzll(ns) : 0;
+    if (b >= HIST_BUCKETS) {
+        b = HIST_BUCKETS - 1;
+    }
+    atomic_fetch_add_explicit(&h->count[b], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->n, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_ns, ns, memory_order_relaxed);
+
+    unsigned long long max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    while (ns > max &&
+           !atomic_compare_exchange_weak_explicit(&h->max_ns, &max, ns,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void hist_merge(struct hist *dst, const struct hist *src) {
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        atomic_fetch_add(&dst->count[b], atomic_load(&src->count[b]));
+    }
+    atomic_fetch_add(&dst->n, atomic_load(&src->n));
+    atomic_fetch_add(&dst->sum_ns, atomic_load(&src->sum_ns));
+    unsigned long long max = atomic_load(&src->max_ns);
+    if (max > atomic_load(&dst->max_ns)) {
+        atomic_store(&dst->max_ns, max);
+    }
+}
+
+uint64_t hist_percentile(const struct hist *h, double p) {
+    unsigned long n = atomic_load(&h->n);
+    if (n == 0) {
+        return 0;
+    }
+    unsigned long target = (unsigned long)(n * p / 100.0 + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+    unsigned long seen = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += atomic_load(&h->count[b]);
+        if (seen >= target) {
+            uint64_t bound = b ? (uint64_t)1 << b : 1;
+            uint64_t max = atomic_load(&h->max_ns);
+            return bound < max ? bound : max;
+        }
+    }
+    return atomic_load(&h->max_ns);
+}
+
+void hist_print(FILE *out, const char *label, const struct hist *h) {
+    unsigned long n = atomic_load(&h->n);
+    double avg = n ? atomic_load(&h->sum_ns) / (double)n : 0.0;
+    fprintf(out, "%s: n=%lu avg=%.1fus p50=%.1fus p90=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus\n",
+            label, n, avg / 1e3,
+            hist_percentile(h, 50) / 1e3, hist_percentile(h, 90) / 1e3,
+            hist_percentile(h, 99) / 1e3, hist_percentile(h, 99.9) / 1e3,
+            atomic_load(&h->max_ns) / 1e3);
+}
@@ -0,0 +1,43 @@
+#ifndef HIST_H
+#define HIST_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Log2 latency histogram. Bucket b counts samples in [2^(b-1), 2^b) ns,
+ * which is plenty to tell microseconds from milliseconds. Updates are
+ * relaxed atomics, so any thread may add to any histogram.
+ */
+#define HIST_BUCKETS 64
+
+struct hist {
+    atomic_ulong count[HIST_BUCKETS];
+    atomic_ulong n;
+    atomic_ullong sum_ns;
+    atomic_ullong max_ns;
+};
+
+/* Monotonic clock in nanoseconds */
+uint64_t now_ns(void);
+
+/* Resets every counter to zero */
+void hist_init(struct hist *h);
+
+/* Records one sample of ns nanoseconds */
+void hist_add(struct hist *h, uint64_t ns);
+
+/* Adds every sample of src to dst */
+void hist_merge(struct hist *dst, const struct hist *src);
+
+/*
+ * Returns the upper bound (ns) of the bucket holding the p-th percentile
+ * (0 < p <= 100), or 0 for an empty histogram.
+ */
+uint64_t hist_percentile(const struct hist *h, double p);
+
+/* Prints "label: n=.. avg=.. p50=.. p90=.. p99=.. p99.9=.. max=.." in us */
+void hist_print(FILE *out, const char *label, const struct hist *h);
+
+#endif /* HIST_H */
@@ -0,0 +1,103 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdlib.h>
+#include "hist.h"
+#include "lockstat.h"
+
+/* One thread's samples, created the first time it records */
+struct thread_stats {
+    struct hist wait;
+    struct hist hold;
+};
+
+/* What the report keeps about each thread once it has exited */
+struct thread_summary {
+    unsigned long acquisitions;
+    double mean_wait_ns;
+};
+
+static pthread_key_t stats_key;
+static _Thread_local struct thread_stats *mine;
+
+/* Totals and per-thread summaries, under totals_lock */
+static pthread_mutex_t totals_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct hist total_wait, total_hold;
+static struct thread_summary *summaries;
+static size_t nsummaries, summaries_cap;
+
+/*
+ * Key destructor: runs as a recording thread exits and folds its
+ * histograms into the totals.
+ */
+static void merge_thread(void *arg) {
+    struct thread_stats *ts = arg;
+    unsigned long n = atomic_load(&ts->wait.n);
+
+    pthread_mutex_lock(&totals_lock);
+    hist_merge(&total_wait, &ts->wait);
+    hist_merge(&total_hold, &ts->hold);
+    if (nsummaries == summaries_cap) {
+        size_t cap = summaries_cap ? summaries_cap * 2 : 64;
+        struct thread_summary *grown = realloc(summaries, cap * sizeof(*grown));
+        if (grown) {
+            summaries = grown;
+            summaries_cap = cap;
+        }
+    }
+    if (nsummaries < summaries_cap) {
+        summaries[nsummaries].acquisitions = n;
+        summaries[nsummaries].mean_wait_ns = n ? atomic_load(&ts->wait.sum_ns) / (double)n : 0.0;
+        nsummaries++;
+    }
+    pthread_mutex_unlock(&totals_lock);
+    free(ts);
+}
+
+void lockstat_init(void) {
+    if (pthread_key_create(&stats_key, merge_thread) != 0) {
+        perror("pthread_key_create");
+        exit(EXIT_FAILURE);
+    }
+    hist_init(&total_wait);
+    hist_init(&total_hold);
+}
+
+void lockstat_record(uint64_t wait_ns, uint64_t hold_ns) {
+    if (!mine) {
+        mine = malloc(sizeof(*mine));
+        if (!mine) {
+            return;
+        }
+        hist_init(&mine->wait);
+        hist_init(&mine->hold);
+        pthread_setspecific(stats_key, mine);
+    }
+    hist_add(&mine->wait, wait_ns);
+    hist_add(&mine->hold, hold_ns);
+}
+
+void lockstat_report(FILE *out, double elapsed_s) {
+    pthread_mutex_lock(&totals_lock);
+    unsigned long total = atomic_load(&total_wait.n);
+    unsigned long min_acq = 0, max_acq = 0;
+    double min_wait = 0, max_wait = 0;
+    for (size_t i = 0; i < nsummaries; i++) {
+        const struct thread_summary *s = &summaries[i];
+        if (i == 0 || s->acquisitions < min_acq) min_acq = s->acquisitions;
+        if (i == 0 || s->acquisitions > max_acq) max_acq = s->acquisitions;
+        if (i == 0 || s->mean_wait_ns < min_wait) min_wait = s->mean_wait_ns;
+        if (i == 0 || s->mean_wait_ns > max_wait) max_wait = s->mean_wait_ns;
+    }
+
+    double waited = atomic_load(&total_wait.sum_ns) / 1e6;
+    double held = atomic_load(&total_hold.sum_ns) / 1e6;
+    fprintf(out, "semaphore: %lu acquisitions by %zu threads (%lu to %lu each)\n",
+            total, nsummaries, min_acq, max_acq);
+    hist_print(out, "  wait", &total_wait);
+    hist_print(out, "  hold", &total_hold);
+    fprintf(out, "  held %.1f%% of the run; %.1f ms waiting vs %.1f ms holding;"
+            " mean wait per thread %.1fus to %.1fus\n",
+            elapsed_s > 0 ? held / elapsed_s / 10.0 : 0.0, waited, held,
+            min_wait / 1e3, max_wait / 1e3);
+    pthread_mutex_unlock(&totals_lock);
+}
@@ -0,0 +1,30 @@
+#ifndef LOCKSTAT_H
+#define LOCKSTAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Contention statistics for the output semaphore.
+ *
+ * Each thread that takes the lock records how long it waited for it and
+ * how long it held it in histograms of its own, so recording never
+ * contends with other threads. A thread's histograms are merged into the
+ * totals when it exits. Callers skip lockstat_record() entirely when
+ * statistics are off, which leaves only a flag test on the write path.
+ */
+
+/* Must be called before any thread records */
+void lockstat_init(void);
+
+/* Records one acquisition by the calling thread */
+void lockstat_record(uint64_t wait_ns, uint64_t hold_ns);
+
+/*
+ * Prints wait and hold percentiles, acquisitions per thread and how busy
+ * the lock was over elapsed_s. Call after every recording thread has
+ * been joined.
+ */
+void lockstat_report(FILE *out, double elapsed_s);
+
+#endif /* LOCKSTAT_H */
@@ -0,0 +1,115 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mmapout.h"
+
+/* Address space reserved for the file up front, so it never has to be
+ * remapped (and moved) while writers are copying into it */
+#define MMAP_RESERVE (SIZE_MAX > 0xffffffffu ? (size_t)1 << 36 : (size_t)1 << 30)
+
+static char *map;
+static int map_fd = -1;
+static size_t grow_chunk;
+
+/* Next free byte; writers reserve [off, off + len) with one fetch-add */
+static _Alignas(64) atomic_size_t next_off;
+/* Current (preallocated) file length; only grows, under grow_lock */
+static _Alignas(64) atomic_size_t file_size;
+static pthread_mutex_t grow_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Lowest reserved offset whose record couldn't be written, or SIZE_MAX.
+ * Everything below it was written, so close truncates the file there
+ * rather than leave a zero-filled hole in the log */
+static atomic_size_t failed_off;
+
+/*
+ * Makes sure the file is at least end bytes long. Pages past EOF raise
+ * SIGBUS when touched, so a writer must not copy until this returns.
+ */
+static int grow_to(size_t end) {
+    int rc = 0;
+    pthread_mutex_lock(&grow_lock);
+    size_t size = atomic_load(&file_size);
+    while (size < end) {
+        /* posix_fallocate both extends the file and reserves its blocks */
+        int err = posix_fallocate(map_fd, size, grow_chunk);
+        if (err != 0) {
+            errno = err;
+            rc = -1;
+            break;
+        }
+        size += grow_chunk;
+        atomic_store(&file_size, size);
+    }
+    pthread_mutex_unlock(&grow_lock);
+    return rc;
+}
+
+/*
+ * Lowers failed_off to off if off is lower.
+ */
+static void note_failure(size_t off) {
+    size_t cur = atomic_load(&failed_off);
+    while (off < cur && !atomic_compare_exchange_weak(&failed_off, &cur, off)) {
+    }
+}
+
+int mmap_out_init(const char *path, size_t chunk) {
+    struct stat st;
+    map_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (map_fd < 0 || fstat(map_fd, &st) < 0) {
+        return -1;
+    }
+    grow_chunk = chunk;
+    atomic_init(&next_off, st.st_size);
+    atomic_init(&file_size, st.st_size);
+    atomic_init(&failed_off, SIZE_MAX);
+
+    map = mmap(NULL, MMAP_RESERVE, PROT_READ | PROT_WRITE, MAP_SHARED, map_fd, 0);
+    if (map == MAP_FAILED) {
+        map = NULL;
+        return -1;
+    }
+    return grow_to(st.st_size + chunk);
+}
+
+int mmap_out_append(const char *rec, size_t len) {
+    size_t off = atomic_fetch_add_explicit(&next_off, len, memory_order_relaxed);
+    size_t end = off + len;
+    if (end > MMAP_RESERVE) {
+        note_failure(off);
+        errno = ENOSPC;
+        return -1;
+    }
+    if (end > atomic_load_explicit(&file_size, memory_order_acquire) && grow_to(end) != 0) {
+        note_failure(off);
+        return -1;
+    }
+    memcpy(map + off, rec, len);
+    return 0;
+}
+
+size_t mmap_out_close(void) {
+    size_t len = atomic_load(&next_off);
+    size_t failed = atomic_load(&failed_off);
+    if (failed < len) {
+        len = failed;
+    }
+    if (map) {
+        munmap(map, MMAP_RESERVE);
+        map = NULL;
+    }
+    if (ftruncate(map_fd, len) != 0) {
+        perror("ftruncate");
+    }
+    close(map_fd);
+    map_fd = -1;
+    return len;
+}
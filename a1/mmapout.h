@@ -0,0 +1,39 @@
+#ifndef MMAPOUT_H
+#define MMAPOUT_H
+
+#include <stddef.h>
+
+/*
+ * Memory-mapped output file for lock-free concurrent appends.
+ *
+ * The file is mapped once over a large address range and grown in big
+ * preallocated chunks. A writer reserves its byte range with an atomic
+ * fetch-add on the end offset and memcpy()s its record in; no lock is
+ * taken except by the rare writer that has to grow the file.
+ */
+
+/*
+ * Maps path (which must exist) for appending after its current contents.
+ * @param path  Output file
+ * @param chunk Bytes to preallocate each time the file has to grow
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int mmap_out_init(const char *path, size_t chunk);
+
+/*
+ * Appends one record at a freshly reserved offset.
+ * @return 0 on success, -1 if the file could not be grown or the
+ *         mapping is full
+ */
+int mmap_out_append(const char *rec, size_t len);
+
+/*
+ * Call once every writer has finished: unmaps the file and truncates it
+ * to the bytes actually written, dropping the unused preallocation. If
+ * any append failed, the file ends where the first failed record would
+ * have started, so it never has a hole.
+ * @return Final file length
+ */
+size_t mmap_out_close(void);
+
+#endif /* MMAPOUT_H */
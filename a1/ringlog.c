@@ -0,0 +1,236 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "ringlog.h"
+
+/* Most slots handed to one writev() */
+#define RING_BATCH 1024
+/* Empty rescans (yielding between them) before the writer goes to sleep */
+#define RING_SPINS 64
+
+/*
+ * One ring slot. seq tells producers and the consumer whose turn it is
+ * (Vyukov's bounded queue): seq == pos means free for the producer that
+ * claims position pos, seq == pos + 1 means filled and ready to write.
+ */
+struct ring_slot {
+    atomic_size_t seq;
+    size_t len;
+    char *data;
+};
+
+static struct ring_slot *slots;
+static char *slot_mem;
+static size_t ring_mask;          /* capacity - 1 */
+static size_t ring_record_max;
+
+/* Next position producers claim; on its own cache line */
+static _Alignas(64) atomic_size_t ring_head;
+/* Next position the writer drains; only the writer touches it */
+static _Alignas(64) size_t ring_tail;
+
+static atomic_int ring_closing;
+/* 1 while the writer is (about to be) asleep on the futex; own cache line */
+static _Alignas(64) atomic_int writer_waiting;
+static pthread_t writer;
+static int out_fd = -1;
+static unsigned long writev_calls;
+
+/*
+ * Writes every iovec, resuming after short writes.
+ */
+static void writev_all(struct iovec *iov, int cnt) {
+    while (cnt > 0) {
+        ssize_t n = writev(out_fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("writev");
+            return;
+        }
+        writev_calls++;
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+/*
+ * Wakes the writer if it has gone to sleep. Callers have just published a
+ * slot or set ring_closing; the fence orders that before reading
+ * writer_waiting, matching the writer's fence between setting it and
+ * rescanning, so either we see it waiting or it sees our slot.
+ */
+static void wake_writer(void) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&writer_waiting, memory_order_relaxed) &&
+        atomic_exchange(&writer_waiting, 0)) {
+        syscall(SYS_futex, &writer_waiting, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+/*
+ * True once the slot after everything drained so far has been published.
+ */
+static int ring_ready(void) {
+    struct ring_slot *s = &slots[ring_tail & ring_mask];
+    return atomic_load_explicit(&s->seq, memory_order_acquire) == ring_tail + 1;
+}
+
+/*
+ * Called by the writer on an empty ring: yields for a few rescans, then
+ * sleeps on a futex until a producer publishes or shutdown begins.
+ */
+static void wait_for_records(void) {
+    for (int i = 0; i < RING_SPINS; i++) {
+        if (ring_ready() || atomic_load(&ring_closing)) {
+            return;
+        }
+        sched_yield();
+    }
+    atomic_store(&writer_waiting, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (!ring_ready() && !atomic_load(&ring_closing) &&
+           atomic_load(&writer_waiting)) {
+        /* Returns at once if a producer already cleared writer_waiting */
+        syscall(SYS_futex, &writer_waiting, FUTEX_WAIT_PRIVATE, 1, NULL, NULL, 0);
+    }
+    atomic_store(&writer_waiting, 0);
+}
+
+/*
+ * Writer thread: gathers every ready slot (up to RING_BATCH) into one
+ * writev(), then hands the slots back to producers. Sleeps on a futex
+ * when the ring is empty and exits once closing is set and nothing is left.
+ */
+static void *ring_writer(void *arg) {
+    (void)arg;
+    struct iovec iov[RING_BATCH];
+
+    for (;;) {
+        int closing = atomic_load_explicit(&ring_closing, memory_order_acquire);
+        int n = 0;
+        while (n < RING_BATCH) {
+            struct ring_slot *s = &slots[(ring_tail + n) & ring_mask];
+            size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+            if (seq != ring_tail + n + 1) {
+                break;
+            }
+            iov[n].iov_base = s->data;
+            iov[n].iov_len = s->len;
+            n++;
+        }
+
+        if (n == 0) {
+            /* closing was read before the scan, so nothing can be missed */
+            if (closing) {
+                break;
+            }
+            wait_for_records();
+            continue;
+        }
+
+        writev_all(iov, n);
+        for (int i = 0; i < n; i++) {
+            struct ring_slot *s = &slots[(ring_tail + i) & ring_mask];
+            atomic_store_explicit(&s->seq, ring_tail + i + ring_mask + 1,
+                                  memory_order_release);
+        }
+        ring_tail += n;
+    }
+    return NULL;
+}
+
+int ring_init(const char *path, size_t capacity, size_t record_max) {
+    size_t cap = 1;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+    ring_mask = cap - 1;
+    ring_record_max = record_max;
+
+    slots = calloc(cap, sizeof(*slots));
+    slot_mem = malloc(cap * record_max);
+    if (!slots || !slot_mem) {
+        return -1;
+    }
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&slots[i].seq, i);
+        slots[i].data = slot_mem + i * record_max;
+    }
+    atomic_init(&ring_head, 0);
+    atomic_init(&ring_closing, 0);
+    atomic_init(&writer_waiting, 0);
+    ring_tail = 0;
+
+    out_fd = open(path, O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (out_fd < 0) {
+        return -1;
+    }
+    errno = pthread_create(&writer, NULL, ring_writer, NULL);
+    return errno ? -1 : 0;
+}
+
+void ring_push(const char *rec, size_t len) {
+    size_t pos = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    struct ring_slot *s;
+
+    /* Claim a slot */
+    for (;;) {
+        s = &slots[pos & ring_mask];
+        size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring_head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            /* Full: let the writer catch up */
+            sched_yield();
+            pos = atomic_load_explicit(&ring_head, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&ring_head, memory_order_relaxed);
+        }
+    }
+
+    /* Fill it and publish to the writer */
+    if (len > ring_record_max) {
+        len = ring_record_max;
+    }
+    memcpy(s->data, rec, len);
+    s->len = len;
+    atomic_store_explicit(&s->seq, pos + 1, memory_order_release);
+    wake_writer();
+}
+
+unsigned long ring_shutdown(void) {
+    atomic_store_explicit(&ring_closing, 1, memory_order_release);
+    wake_writer();
+    pthread_join(writer, NULL);
+    close(out_fd);
+    out_fd = -1;
+    free(slot_mem);
+    free(slots);
+    return writev_calls;
+}
@@ -0,0 +1,37 @@
+#ifndef RINGLOG_H
+#define RINGLOG_H
+
+#include <stddef.h>
+
+/*
+ * Lock-free multi-producer / single-consumer record logger.
+ *
+ * Bots copy their record into a slot of a bounded ring (claiming it with
+ * a compare-and-swap, no lock), and one writer thread drains runs of
+ * ready slots straight to a file descriptor that stays open, with a
+ * single writev() per batch.
+ */
+
+/*
+ * Opens path for appending and starts the writer thread.
+ * @param path       Output file (must already exist)
+ * @param capacity   Number of slots; rounded up to a power of two
+ * @param record_max Largest record in bytes; longer ones are truncated
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int ring_init(const char *path, size_t capacity, size_t record_max);
+
+/*
+ * Queues one record. Never takes a lock; if the ring is full the caller
+ * yields until the writer frees a slot.
+ */
+void ring_push(const char *rec, size_t len);
+
+/*
+ * Call once every producer has finished: drains what is left, stops the
+ * writer thread and closes the file.
+ * @return Number of writev() calls the writer made
+ */
+unsigned long ring_shutdown(void);
+
+#endif /* RINGLOG_H */
@@ -0,0 +1,310 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "sched.h"
+
+/* Wheel resolution and size: 1024 x 10 ms covers periods up to ~10 s;
+ * longer ones simply go round the wheel again */
+#define TICK_MS      10
+#define WHEEL_SLOTS  1024
+
+/* One bot waiting in the wheel or queued on a worker */
+struct bot_task {
+    int id;
+    int remaining;            /* Runs left */
+    uint64_t due_tick;        /* Tick at which it should run next */
+    struct bot_task *next;    /* Wheel slot chain */
+};
+
+/* A worker's deque: the owner pushes/pops at the back, thieves take the
+ * front. A short mutex per deque keeps it simple and uncontended */
+struct deque {
+    pthread_mutex_t lock;
+    struct bot_task **buf;
+    size_t cap, head, count;  /* Circular buffer */
+};
+
+static struct bot_task *wheel[WHEEL_SLOTS];
+static pthread_mutex_t wheel_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t wheel_tick;          /* Last tick processed, under wheel_lock */
+static struct timespec wheel_epoch;  /* Time of tick 0 */
+
+static struct deque *deques;
+static int nworkers;
+
+/* Sleeping workers wait here until something is queued. queued and
+ * idle_workers are atomics so the busy path never touches idle_lock */
+static pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+static atomic_long queued;           /* Tasks sitting in deques */
+static atomic_int idle_workers;      /* Workers in (or entering) cond_wait */
+static int stopping;                 /* Under idle_lock */
+
+/* wheel_run() waits here for the last bot */
+static pthread_mutex_t done_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static int bots_left;
+
+static void (*bot_step)(int id);
+static unsigned (*bot_period)(int id);
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)(ts.tv_sec - wheel_epoch.tv_sec) * 1000 +
+           (ts.tv_nsec - wheel_epoch.tv_nsec) / 1000000;
+}
+
+static void deque_push(struct deque *d, struct bot_task *t) {
+    pthread_mutex_lock(&d->lock);
+    if (d->count == d->cap) {
+        size_t cap = d->cap ? d->cap * 2 : 64;
+        struct bot_task **buf = malloc(cap * sizeof(*buf));
+        if (!buf) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < d->count; i++) {
+            buf[i] = d->buf[(d->head + i) % d->cap];
+        }
+        free(d->buf);
+        d->buf = buf;
+        d->cap = cap;
+        d->head = 0;
+    }
+    d->buf[(d->head + d->count) % d->cap] = t;
+    d->count++;
+    pthread_mutex_unlock(&d->lock);
+}
+
+/* Owner end (newest first) when own is set, otherwise the steal end */
+static struct bot_task *deque_pop(struct deque *d, int own) {
+    struct bot_task *t = NULL;
+    pthread_mutex_lock(&d->lock);
+    if (d->count > 0) {
+        d->count--;
+        if (own) {
+            t = d->buf[(d->head + d->count) % d->cap];
+        } else {
+            t = d->buf[d->head];
+            d->head = (d->head + 1) % d->cap;
+        }
+    }
+    pthread_mutex_unlock(&d->lock);
+    return t;
+}
+
+/* Queue a task on worker w and wake a worker if any are asleep. The
+ * increment of queued and the read of idle_workers pair with the reverse
+ * order in worker(), so either it sees the task or we see it sleeping */
+static void make_ready(int w, struct bot_task *t) {
+    deque_push(&deques[w], t);
+    atomic_fetch_add(&queued, 1);
+    if (atomic_load(&idle_workers) > 0) {
+        pthread_mutex_lock(&idle_lock);
+        pthread_cond_signal(&idle_cond);
+        pthread_mutex_unlock(&idle_lock);
+    }
+}
+
+/* Put a task in the wheel period_ms from now */
+static void schedule(struct bot_task *t, unsigned period_ms) {
+    pthread_mutex_lock(&wheel_lock);
+    t->due_tick = (now_ms() + period_ms + TICK_MS - 1) / TICK_MS;
+    if (t->due_tick <= wheel_tick) {
+        t->due_tick = wheel_tick + 1;
+    }
+    struct bot_task **slot = &wheel[t->due_tick % WHEEL_SLOTS];
+    t->next = *slot;
+    *slot = t;
+    pthread_mutex_unlock(&wheel_lock);
+}
+
+/* Find work: own deque first, then steal from the others */
+static struct bot_task *next_task(int self) {
+    struct bot_task *t = deque_pop(&deques[self], 1);
+    for (int i = 1; !t && i < nworkers; i++) {
+        t = deque_pop(&deques[(self + i) % nworkers], 0);
+    }
+    return t;
+}
+
+static void *worker(void *arg) {
+    int self = (int)(intptr_t)arg;
+    for (;;) {
+        struct bot_task *t = next_task(self);
+        if (!t) {
+            /* Nothing anywhere: sleep until a task is queued or we stop */
+            pthread_mutex_lock(&idle_lock);
+            atomic_fetch_add(&idle_workers, 1);
+            while (atomic_load(&queued) == 0 && !stopping) {
+                pthread_cond_wait(&idle_cond, &idle_lock);
+            }
+            atomic_fetch_sub(&idle_workers, 1);
+            int stop = stopping && atomic_load(&queued) == 0;
+            pthread_mutex_unlock(&idle_lock);
+            if (stop) {
+                return NULL;
+            }
+            continue;
+        }
+        atomic_fetch_sub(&queued, 1);
+
+        bot_step(t->id);
+
+        if (--t->remaining == 0) {
+            free(t);
+            pthread_mutex_lock(&done_lock);
+            if (--bots_left == 0) {
+                pthread_cond_signal(&done_cond);
+            }
+            pthread_mutex_unlock(&done_lock);
+            continue;
+        }
+        unsigned period = bot_period(t->id);
+        if (period == 0) {
+            make_ready(self, t);
+        } else {
+            schedule(t, period);
+        }
+    }
+}
+
+/* Timer thread: every tick, hand every due task to a worker */
+static void *ticker(void *arg) {
+    (void)arg;
+    int rr = 0;  /* Round-robin worker choice */
+    for (;;) {
+        pthread_mutex_lock(&idle_lock);
+        int stop = stopping;
+        pthread_mutex_unlock(&idle_lock);
+        if (stop) {
+            return NULL;
+        }
+
+        /* Sleep until the start of the next tick */
+        pthread_mutex_lock(&wheel_lock);
+        uint64_t next = wheel_tick + 1;
+        pthread_mutex_unlock(&wheel_lock);
+        uint64_t ms = next * TICK_MS;
+        struct timespec wake = wheel_epoch;
+        wake.tv_sec += ms / 1000;
+        wake.tv_nsec += (ms % 1000) * 1000000;
+        if (wake.tv_nsec >= 1000000000) {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR) {
+        }
+
+        /* Process every tick that has passed (catches up after oversleeping) */
+        uint64_t now_tick = now_ms() / TICK_MS;
+        struct bot_task *ready = NULL;
+        pthread_mutex_lock(&wheel_lock);
+        while (wheel_tick < now_tick) {
+            wheel_tick++;
+            struct bot_task **p = &wheel[wheel_tick % WHEEL_SLOTS];
+            while (*p) {
+                struct bot_task *t = *p;
+                if (t->due_tick <= wheel_tick) {
+                    *p = t->next;
+                    t->next = ready;
+                    ready = t;
+                } else {
+                    p = &t->next;  /* A later lap of the wheel */
+                }
+            }
+        }
+        pthread_mutex_unlock(&wheel_lock);
+
+        while (ready) {
+            struct bot_task *t = ready;
+            ready = t->next;
+            make_ready(rr, t);
+            rr = (rr + 1) % nworkers;
+        }
+    }
+}
+
+void wheel_run(int nbots, int iters, int workers,
+               void (*step)(int id), unsigned (*period_ms)(int id)) {
+    if (workers <= 0) {
+        workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    nworkers = workers > 0 ? workers : 1;
+    bot_step = step;
+    bot_period = period_ms;
+    bots_left = nbots;
+    stopping = 0;
+    atomic_init(&queued, 0);
+    atomic_init(&idle_workers, 0);
+    wheel_tick = 0;
+    clock_gettime(CLOCK_MONOTONIC, &wheel_epoch);
+
+    deques = calloc(nworkers, sizeof(*deques));
+    pthread_t *threads = malloc(nworkers * sizeof(*threads));
+    if (!deques || !threads) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < nworkers; i++) {
+        pthread_mutex_init(&deques[i].lock, NULL);
+    }
+
+    /* Every bot starts with its first pause, just like bot_thread() */
+    for (int id = 1; id <= nbots && iters > 0; id++) {
+        struct bot_task *t = malloc(sizeof(*t));
+        if (!t) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        t->id = id;
+        t->remaining = iters;
+        unsigned period = period_ms(id);
+        if (period == 0) {
+            make_ready(id % nworkers, t);
+        } else {
+            schedule(t, period);
+        }
+    }
+    if (iters <= 0) {
+        bots_left = 0;
+    }
+
+    pthread_t timer;
+    if (pthread_create(&timer, NULL, ticker, NULL) != 0) {
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < nworkers; i++) {
+        if (pthread_create(&threads[i], NULL, worker, (void *)(intptr_t)i) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    pthread_mutex_lock(&done_lock);
+    while (bots_left > 0) {
+        pthread_cond_wait(&done_cond, &done_lock);
+    }
+    pthread_mutex_unlock(&done_lock);
+
+    pthread_mutex_lock(&idle_lock);
+    stopping = 1;
+    pthread_cond_broadcast(&idle_cond);
+    pthread_mutex_unlock(&idle_lock);
+    pthread_join(timer, NULL);
+    for (int i = 0; i < nworkers; i++) {
+        pthread_join(threads[i], NULL);
+        pthread_mutex_destroy(&deques[i].lock);
+        free(deques[i].buf);
+    }
+    free(deques);
+    free(threads);
+}
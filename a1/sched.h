@@ -0,0 +1,27 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+/*
+ * Timer-wheel bot scheduler.
+ *
+ * Instead of one sleeping thread per bot, every bot is a small task that
+ * sits in a timer wheel until its next wake-up. A timer thread moves due
+ * tasks onto the deques of a fixed pool of worker threads, which run them
+ * and steal from each other when their own deque is empty. Each deque is
+ * guarded by its own short mutex; only the queued/idle handshake that
+ * decides whether a sleeping worker needs waking is done with atomics.
+ */
+
+/*
+ * Runs nbots bots (IDs 1..nbots) to completion and returns once every
+ * bot has run iters times.
+ * @param nbots     Number of bots
+ * @param iters     Times each bot runs
+ * @param workers   Worker threads (<= 0 means one per online CPU)
+ * @param step      Called on a worker each time bot id is due
+ * @param period_ms Delay before each run of bot id; 0 runs it back to back
+ */
+void wheel_run(int nbots, int iters, int workers,
+               void (*step)(int id), unsigned (*period_ms)(int id));
+
+#endif /* SCHED_H */
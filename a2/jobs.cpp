@@ -0,0 +1,219 @@
+// jobs.cpp
+#include "xsh.h"
+#include <iostream>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// A pipeline running in the background
+struct Job {
+    int id;                     // Job number shown as [id]
+    std::string text;           // Command line as typed, minus the '&'
+    std::vector<pid_t> pids;    // One child per stage; -1 if it never forked, 0 once reaped
+    int status = 0;             // Exit status of the last stage
+    bool done = false;          // Every stage reaped, not yet reported
+};
+
+// Background jobs in start order
+static std::vector<Job> job_table;
+
+// Finished jobs kept for a later "wait" or "jobs" when nothing reports them;
+// older ones are forgotten so a long script doesn't grow the table forever
+static const size_t MAX_FINISHED_JOBS = 256;
+
+// Set by the SIGCHLD handler; reap_jobs() only scans when it is set
+static volatile sig_atomic_t child_exited = 0;
+
+static void on_sigchld(int) {
+    child_exited = 1;
+}
+
+// Install the SIGCHLD handler; SA_RESTART keeps reads and waits going
+void init_jobs() {
+    struct sigaction sa = {};
+    sa.sa_handler = on_sigchld;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &sa, nullptr);
+}
+
+// Reap one child of job; blocking waits until it exits. Returns true once
+// the child has been collected
+static bool reap_pid(Job &job, size_t stage, bool block) {
+    pid_t pid = job.pids[stage];
+    if (pid == 0) {
+        return true;
+    }
+    if (pid < 0) {
+        // Never started: a failed last stage fails the job, as in wait_pids()
+        if (stage + 1 == job.pids.size()) {
+            job.status = 1;
+        }
+        job.pids[stage] = 0;
+        return true;
+    }
+    int status = 0;
+    pid_t r;
+    while ((r = waitpid(pid, &status, block ? 0 : WNOHANG)) < 0 && errno == EINTR) {
+    }
+    if (r == 0) {
+        return false;
+    }
+    if (r == pid && stage + 1 == job.pids.size()) {
+        job.status = exit_status(status);
+    }
+    job.pids[stage] = 0;
+    return true;
+}
+
+// Collect every stage of job, optionally blocking; true once all are gone
+static bool reap_job(Job &job, bool block) {
+    bool finished = true;
+    for (size_t i = 0; i < job.pids.size(); ++i) {
+        finished &= reap_pid(job, i, block);
+    }
+    return finished;
+}
+
+// "Running", "Done" or "Exit n", as shown by jobs and completion notices
+static std::string job_state(const Job &job) {
+    if (!job.done) {
+        return "Running";
+    }
+    return job.status == 0 ? "Done" : "Exit " + std::to_string(job.status);
+}
+
+// Start a background pipeline and announce "[id] pid" like sh does
+int start_job(const std::vector<Command> &commands, std::string_view text) {
+    Job job;
+    job.id = job_table.empty() ? 1 : job_table.back().id + 1;
+    job.text = text;
+
+    // Without job control a background job must not read the terminal
+    // along with the prompt, so as in sh its stdin is /dev/null (a "<" of
+    // its own still takes precedence)
+    int null_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (null_fd < 0) {
+        perror("/dev/null");
+        null_fd = STDIN_FILENO;
+    }
+    job.pids = launch_pipeline(commands, nullptr, null_fd);
+    std::cerr << "[" << job.id << "] " << job.pids.back() << "\n";
+    job_table.push_back(job);
+    return 0;
+}
+
+void reap_jobs(bool report) {
+    if (!child_exited) {
+        return;
+    }
+    child_exited = 0;
+    for (auto &job : job_table) {
+        if (!job.done) {
+            job.done = reap_job(job, false);
+        }
+    }
+
+    // Without a terminal to report to, finished jobs stay in the table so a
+    // later "wait" or "jobs" can still see their status, up to a limit
+    if (!report) {
+        size_t finished = 0;
+        for (const auto &job : job_table) {
+            finished += job.done;
+        }
+        for (auto it = job_table.begin(); it != job_table.end() && finished > MAX_FINISHED_JOBS;) {
+            if (it->done) {
+                it = job_table.erase(it);
+                --finished;
+            } else {
+                ++it;
+            }
+        }
+        return;
+    }
+    for (auto it = job_table.begin(); it != job_table.end();) {
+        if (!it->done) {
+            ++it;
+            continue;
+        }
+        std::cerr << "[" << it->id << "]+ " << job_state(*it) << "\t" << it->text << "\n";
+        it = job_table.erase(it);
+    }
+}
+
+// Find the job named by spec ("%n", or a pid of one of its stages); an empty
+// spec means the most recent job
+static std::vector<Job>::iterator find_job(const std::string &spec) {
+    if (spec.empty()) {
+        return job_table.empty() ? job_table.end() : job_table.end() - 1;
+    }
+    bool by_id = spec[0] == '%';
+    long n = std::strtol(spec.c_str() + (by_id ? 1 : 0), nullptr, 10);
+    for (auto it = job_table.begin(); it != job_table.end(); ++it) {
+        if (by_id && it->id == n) {
+            return it;
+        }
+        for (pid_t pid : it->pids) {
+            if (!by_id && pid > 0 && pid == n) {
+                return it;
+            }
+        }
+    }
+    return job_table.end();
+}
+
+// Block until the given job finishes, drop it from the table, return status
+static int wait_job(std::vector<Job>::iterator it) {
+    reap_job(*it, true);
+    int status = it->status;
+    job_table.erase(it);
+    return status;
+}
+
+int run_job_builtin(const Command &cmd) {
+    std::string_view name = cmd.argv[0];
+    std::string spec = cmd.argc > 1 ? cmd.argv[1] : "";
+
+    if (name == "jobs") {
+        reap_jobs(false);
+        std::string out;
+        for (auto it = job_table.begin(); it != job_table.end();) {
+            out += "[" + std::to_string(it->id) + "] " + job_state(*it) + "\t" + it->text + "\n";
+            // Finished jobs are reported once, then forgotten
+            it = it->done ? job_table.erase(it) : it + 1;
+        }
+        builtin_output(cmd, out);
+        return 0;
+    }
+
+    if (name == "wait") {
+        // With no argument, wait for every background job (status 0, as in sh)
+        if (spec.empty()) {
+            while (!job_table.empty()) {
+                wait_job(job_table.begin());
+            }
+            return 0;
+        }
+        auto it = find_job(spec);
+        if (it == job_table.end()) {
+            std::cerr << "wait: " << spec << ": no such job\n";
+            return 127;
+        }
+        return wait_job(it);
+    }
+
+    if (name == "fg") {
+        auto it = find_job(spec);
+        if (it == job_table.end()) {
+            std::cerr << "fg: " << (spec.empty() ? "current" : spec) << ": no such job\n";
+            return 1;
+        }
+        builtin_output(cmd, it->text + "\n");
+        return wait_job(it);
+    }
+    return -1;
+}
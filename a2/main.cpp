@@ -1,30 +1,155 @@
 // main.cpp
 #include "xsh.h"
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Size of each read when a script arrives on a pipe or terminal
+static const size_t BATCH_CHUNK = 1 << 20;
+
+// Run every line in buf[0..len) without prompting. Stops at "exit", or at the
+// first failing line when stop_on_error is set; *done reports either case.
+// Returns the status of the last line executed.
+static int run_buffer(const char *buf, size_t len, bool stop_on_error,
+                      int status, bool *done) {
+    const char *p = buf;
+    const char *end = buf + len;
+    while (p < end) {
+        const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+        const char *eol = nl ? nl : end;
+        std::string_view line(p, eol - p);
+        p = nl ? nl + 1 : end;
+
+        if (handle_exit(line)) {
+            *done = true;
+            break;
+        }
+        reap_jobs(false);
+        status = run_line(line);
+        if (status != 0 && stop_on_error) {
+            *done = true;
+            break;
+        }
+    }
+    return status;
+}
+
+// Run a script arriving on fd in large chunks, carrying any partial last
+// line over to the next read
+static int run_stream(int fd, bool stop_on_error) {
+    std::string buf;
+    std::vector<char> chunk(BATCH_CHUNK);
+    int status = 0;
+    bool done = false;
+    ssize_t n;
+    while (!done && (n = read(fd, chunk.data(), chunk.size())) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("read");
+            return 1;
+        }
+        buf.append(chunk.data(), n);
+        size_t last_nl = buf.rfind('\n');
+        if (last_nl == std::string::npos) {
+            continue;
+        }
+        status = run_buffer(buf.data(), last_nl + 1, stop_on_error, status, &done);
+        buf.erase(0, last_nl + 1);
+    }
+    if (!done && !buf.empty()) {
+        status = run_buffer(buf.data(), buf.size(), stop_on_error, status, &done);
+    }
+    return status;
+}
+
+// Run a script file, mapping it into memory when it is a regular file
+static int run_file(const char *path, bool stop_on_error) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return 127;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        int status = run_stream(fd, stop_on_error);
+        close(fd);
+        return status;
+    }
+
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    bool done = false;
+    int status = run_buffer(static_cast<const char *>(map), st.st_size,
+                            stop_on_error, 0, &done);
+    munmap(map, st.st_size);
+    return status;
+}
+
+// Usage: dsh [-e] [-c command | script]
+//   -c command  run command (may contain several lines) and exit
+//   script      run each line of the file and exit
+//   -e          stop at the first line that fails
+// With neither, runs interactively, or as a batch when stdin isn't a terminal
+int main(int argc, char *argv[]) {
+    bool stop_on_error = false;
+    const char *command = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "ec:")) != -1) {
+        switch (opt) {
+        case 'e':
+            stop_on_error = true;
+            break;
+        case 'c':
+            command = optarg;
+            break;
+        default:
+            std::cerr << "usage: " << argv[0] << " [-e] [-c command | script]\n";
+            return 2;
+        }
+    }
+
+    init_jobs();
+
+    // Non-interactive modes: no prompt, status of the last pipeline
+    if (command) {
+        bool done = false;
+        return run_buffer(command, strlen(command), stop_on_error, 0, &done);
+    }
+    if (optind < argc) {
+        return run_file(argv[optind], stop_on_error);
+    }
+    if (!isatty(STDIN_FILENO)) {
+        return run_stream(STDIN_FILENO, stop_on_error);
+    }
+
+    int status = 0;
 
-int main() {
     // Display the shell prompt
     print_prompt();
-    while (true) {
+    while (std::cin) {
         // Read a full line of user input
         std::string line = read_input();
 
-        // Validate the input (checks piping and argument count)
-        if (!validate_input(line)) {
-            print_prompt();        // Invalid format: re-prompt and continue
-            continue;
-        }
+        // EOF (Ctrl-D) with nothing typed: leave without running the empty line
+        if (!std::cin) break;
 
         // Handle "exit" command: break out of the loop if requested
         if (handle_exit(line)) break;
 
-        // Parse the line into a sequence of commands (with their args)
-        auto commands = parse_line(line);
-
-        // Execute the parsed commands (handles piping)
-        execute_commands(commands);
+        // Validate, parse and execute the line (handles piping)
+        status = run_line(line);
 
-        // After execution, display prompt again
+        // Report finished background jobs, then display prompt again
+        reap_jobs(true);
         print_prompt();
     }
-    return 0;            // Exit with status 0
-}
\ No newline at end of file
+    return status;       // Exit with the last pipeline's status
+}
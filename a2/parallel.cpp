@@ -0,0 +1,270 @@
+// parallel.cpp
+#include "xsh.h"
+#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// One invocation of the command template
+struct ParallelJob {
+    std::vector<std::string> args;  // Template with this job's input filled in
+    std::vector<char *> argv;       // Points into args, NULL-terminated
+    Command cmd;                    // Runs argv
+    pid_t pid = -1;
+    int out_fd = -1;        // Read end of the job's stdout pipe while running
+    std::string out;        // Output held back until earlier jobs are flushed
+    bool finished = false;  // Output drained and child reaped
+    int status = 0;
+};
+
+// Build the command for one input: substitute it for every "{}" in the
+// template, or append it when the template has no placeholder
+static void make_job(const std::vector<std::string_view> &tmpl,
+                     const std::string &input, ParallelJob &job) {
+    bool substituted = false;
+    for (auto arg : tmpl) {
+        std::string a(arg);
+        for (size_t pos; (pos = a.find("{}")) != std::string::npos;) {
+            a.replace(pos, 2, input);
+            substituted = true;
+        }
+        job.args.push_back(std::move(a));
+    }
+    if (!substituted) {
+        job.args.push_back(input);
+    }
+
+    // args is complete, so pointers into it stay put from here on
+    for (auto &a : job.args) {
+        job.argv.push_back(a.data());
+    }
+    job.argv.push_back(nullptr);
+    job.cmd.argv = job.argv.data();
+    job.cmd.argc = job.args.size();
+}
+
+// Read newline-separated inputs from fd until EOF
+static void read_inputs(int fd, std::vector<std::string> &inputs) {
+    std::string buf;
+    char chunk[1 << 16];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("parallel: read");
+            break;
+        }
+        buf.append(chunk, n);
+    }
+    size_t start = 0;
+    while (start < buf.size()) {
+        size_t nl = buf.find('\n', start);
+        if (nl == std::string::npos) nl = buf.size();
+        if (nl > start) {
+            inputs.push_back(buf.substr(start, nl - start));
+        }
+        start = nl + 1;
+    }
+}
+
+// Fork a job with its stdout on a private pipe; the read end is close-on-exec
+// so other jobs never hold it open and delay its EOF
+static void fork_job(ParallelJob &job) {
+    int p[2];
+    if (pipe2(p, O_CLOEXEC) < 0) {
+        perror("parallel: pipe");
+        job.finished = true;
+        job.status = 1;
+        return;
+    }
+    job.pid = execute_single(job.cmd, 0, p[1]);
+    close(p[1]);
+    if (job.pid < 0) {
+        close(p[0]);
+        job.finished = true;
+        job.status = 1;
+        return;
+    }
+    job.out_fd = p[0];
+}
+
+// The job has closed stdout, normally because it is exiting: reap it
+static void finish_job(ParallelJob &job) {
+    close(job.out_fd);
+    job.out_fd = -1;
+    int status = 0;
+    while (waitpid(job.pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    job.status = exit_status(status);
+    job.finished = true;
+}
+
+// Pull whatever the job has written; on EOF reap it and mark it finished.
+// A job whose turn it is (to >= 0, nothing held back) has its output
+// spliced straight to the shell's output so the bytes stay in the kernel;
+// only jobs still waiting for their turn are buffered here
+static void drain_job(ParallelJob &job, int to, bool &can_splice) {
+    ssize_t n;
+    if (to >= 0 && can_splice && job.out.empty()) {
+        n = splice(job.out_fd, nullptr, to, nullptr, 1 << 20, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n > 0 || (n < 0 && errno == EINTR)) {
+            return;
+        }
+        if (n == 0) {
+            finish_job(job);
+            return;
+        }
+        // EINVAL: the output can't be spliced to (e.g. a terminal or an
+        // O_APPEND file), so copy through userspace from now on
+        can_splice = false;
+    }
+
+    char chunk[1 << 16];
+    n = read(job.out_fd, chunk, sizeof(chunk));
+    if (n < 0 && errno == EINTR) {
+        return;
+    }
+    if (n > 0) {
+        if (to >= 0 && job.out.empty()) {
+            write_all(to, chunk, n);
+        } else {
+            job.out.append(chunk, n);
+        }
+        return;
+    }
+    finish_job(job);
+}
+
+int run_parallel(const Command &cmd) {
+    long max_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    bool verbose = false;
+    size_t i = 1;
+
+    // Options come before the command template
+    for (; i < cmd.argc && cmd.argv[i][0] == '-'; ++i) {
+        std::string_view opt = cmd.argv[i];
+        if (opt == "-v") {
+            verbose = true;
+        } else if (opt.substr(0, 2) == "-j") {
+            const char *val = opt.size() > 2 ? cmd.argv[i] + 2
+                            : (i + 1 < cmd.argc ? cmd.argv[++i] : "");
+            max_jobs = std::strtol(val, nullptr, 10);
+        } else {
+            break;
+        }
+    }
+    if (max_jobs < 1) {
+        std::cerr << "parallel: -j needs a positive job count\n";
+        return 2;
+    }
+
+    std::vector<std::string_view> tmpl;
+    for (; i < cmd.argc && std::string_view(cmd.argv[i]) != ":::"; ++i) {
+        tmpl.push_back(cmd.argv[i]);
+    }
+    if (tmpl.empty()) {
+        std::cerr << "usage: parallel [-j N] [-v] command [args...] [::: input...]\n";
+        return 2;
+    }
+
+    // Inputs follow ":::", otherwise they are read from stdin (or "< file")
+    std::vector<std::string> inputs;
+    if (i < cmd.argc) {
+        inputs.assign(cmd.argv + i + 1, cmd.argv + cmd.argc);
+    } else {
+        int in_fd = cmd.in_file ? open(cmd.in_file, O_RDONLY | O_CLOEXEC) : 0;
+        if (in_fd < 0) {
+            perror(cmd.in_file);
+            return 1;
+        }
+        read_inputs(in_fd, inputs);
+        if (in_fd != 0) {
+            close(in_fd);
+        }
+    }
+
+    int out_fd = open_output(cmd);
+    if (out_fd < 0) {
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<ParallelJob> jobs(inputs.size());
+    for (size_t j = 0; j < inputs.size(); ++j) {
+        make_job(tmpl, inputs[j], jobs[j]);
+    }
+
+    size_t next_start = 0;  // First job not yet forked
+    size_t next_flush = 0;  // First job whose output hasn't been fully written
+    size_t running = 0;
+    bool can_splice = true;
+    std::vector<struct pollfd> fds;
+    std::vector<size_t> fd_job;
+
+    while (next_flush < jobs.size()) {
+        // Keep up to max_jobs children going
+        while (running < static_cast<size_t>(max_jobs) && next_start < jobs.size()) {
+            fork_job(jobs[next_start]);
+            if (!jobs[next_start].finished) {
+                ++running;
+            }
+            ++next_start;
+        }
+
+        // Wait for output (or EOF) from any running job
+        fds.clear();
+        fd_job.clear();
+        for (size_t j = next_flush; j < next_start; ++j) {
+            if (jobs[j].out_fd >= 0) {
+                fds.push_back({jobs[j].out_fd, POLLIN, 0});
+                fd_job.push_back(j);
+            }
+        }
+        if (!fds.empty() && poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+            perror("parallel: poll");
+            break;
+        }
+        for (size_t k = 0; k < fds.size(); ++k) {
+            if (fds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+                drain_job(jobs[fd_job[k]], fd_job[k] == next_flush ? out_fd : -1,
+                          can_splice);
+                if (jobs[fd_job[k]].finished) {
+                    --running;
+                }
+            }
+        }
+
+        // The oldest unflushed job streams straight through (drain_job writes
+        // it directly); later ones wait their turn so output appears in input
+        // order, and what they buffered is written once they reach the head
+        while (next_flush < next_start) {
+            ParallelJob &head = jobs[next_flush];
+            write_all(out_fd, head.out.data(), head.out.size());
+            head.out.clear();
+            if (!head.finished) {
+                break;
+            }
+            head.out.shrink_to_fit();
+            ++next_flush;
+        }
+    }
+    if (out_fd != 0 && out_fd != 1) {
+        close(out_fd);
+    }
+
+    size_t failed = 0;
+    for (const auto &job : jobs) {
+        failed += job.status != 0;
+    }
+    if (verbose) {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        fprintf(stderr, "parallel: %zu jobs, %zu failed, %.3f s, %.1f jobs/s (-j %ld)\n",
+                jobs.size(), failed, secs, secs > 0 ? jobs.size() / secs : 0.0, max_jobs);
+    }
+    return failed > 101 ? 101 : static_cast<int>(failed);
+}
@@ -0,0 +1,202 @@
+// parse.cpp
+#include "xsh.h"
+#include <iostream>
+
+// What the word currently being built will become
+enum WordRole { ARG, IN_FILE, OUT_FILE, ERR_FILE };
+
+// Single-pass lexer: words are unescaped straight into the arena and their
+// addresses collected in out.words, so no intermediate strings are built
+bool parse_line(std::string_view line, Pipeline &out) {
+    out.stages.clear();
+    out.words.clear();
+    out.background = false;
+
+    // Unescaping never lengthens a word and each word gains one NUL, so the
+    // arena needs at most line.size() + 1 bytes and never moves mid-parse
+    if (out.arena.size() < line.size() + 1) {
+        out.arena.resize(line.size() + 1);
+    }
+    char *arena = out.arena.data();
+    size_t pos = 0;             // Next free byte in the arena
+
+    Command cur;                // Stage being built
+    WordRole role = ARG;        // Where the next word goes
+    bool in_word = false;       // A word (possibly "") has been started
+    bool quoted = false;        // The current word used quotes or escapes
+    bool seen = false;          // The line had anything besides blanks
+    size_t word_start = 0;
+
+    auto fail = [](const char *msg) {
+        std::cerr << msg << "\n";
+        return false;
+    };
+    auto begin_word = [&]() {
+        if (!in_word) {
+            in_word = true;
+            quoted = false;
+            word_start = pos;
+            seen = true;
+        }
+    };
+    auto end_word = [&]() {
+        if (!in_word) {
+            return;
+        }
+        arena[pos++] = '\0';
+        char *w = arena + word_start;
+        switch (role) {
+        case ARG:      out.words.push_back(w); ++cur.argc; break;
+        case IN_FILE:  cur.in_file = w; break;
+        case OUT_FILE: cur.out_file = w; break;
+        case ERR_FILE: cur.err_file = w; break;
+        }
+        role = ARG;
+        in_word = false;
+    };
+    auto redirect = [&](WordRole next) {
+        end_word();
+        if (role != ARG) {
+            return false;       // Two operators in a row
+        }
+        role = next;
+        seen = true;
+        return true;
+    };
+    auto end_stage = [&]() {
+        end_word();
+        if (role != ARG) {
+            return fail("Missing file name for redirection");
+        }
+        if (cur.argc == 0 && !cur.in_file && !cur.out_file && !cur.err_file) {
+            return fail("Invalid command format");
+        }
+        out.words.push_back(nullptr);
+        out.stages.push_back(cur);
+        cur = Command();
+        return true;
+    };
+
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        switch (c) {
+        case ' ': case '\t': case '\r': case '\n':
+            end_word();
+            break;
+
+        case '|':
+            if (!end_stage()) {
+                return false;
+            }
+            break;
+
+        case '<':
+            if (!redirect(IN_FILE)) {
+                return fail("Missing file name for redirection");
+            }
+            break;
+
+        case '>':
+            // "2>" redirects stderr only when an unquoted 2 is the whole word
+            if (in_word && !quoted && pos - word_start == 1 && arena[word_start] == '2') {
+                pos = word_start;
+                in_word = false;
+                if (!redirect(ERR_FILE)) {
+                    return fail("Missing file name for redirection");
+                }
+                break;
+            }
+            cur.append = i + 1 < line.size() && line[i + 1] == '>';
+            i += cur.append;
+            if (!redirect(OUT_FILE)) {
+                return fail("Missing file name for redirection");
+            }
+            break;
+
+        case '&':
+            // Only valid as the last thing on the line (comments aside)
+            end_word();
+            for (size_t j = i + 1; j < line.size() && line[j] != '#'; ++j) {
+                if (line[j] != ' ' && line[j] != '\t' && line[j] != '\r') {
+                    return fail("Unexpected '&'");
+                }
+            }
+            if (!seen) {
+                return fail("Unexpected '&'");
+            }
+            out.background = true;
+            i = line.size();
+            break;
+
+        case '#':
+            // A comment runs to the end of the line, but only at a word start
+            if (!in_word) {
+                i = line.size();
+                break;
+            }
+            arena[pos++] = c;
+            break;
+
+        case '\'': {
+            // Everything up to the next ' is literal
+            begin_word();
+            quoted = true;
+            size_t close = line.find('\'', i + 1);
+            if (close == std::string_view::npos) {
+                return fail("Unterminated quote");
+            }
+            line.copy(arena + pos, close - i - 1, i + 1);
+            pos += close - i - 1;
+            i = close;
+            break;
+        }
+
+        case '"': {
+            // Backslash only escapes the characters sh treats specially here
+            begin_word();
+            quoted = true;
+            size_t j = i + 1;
+            for (; j < line.size() && line[j] != '"'; ++j) {
+                if (line[j] == '\\' && j + 1 < line.size()) {
+                    char n = line[j + 1];
+                    if (n == '"' || n == '\\' || n == '$' || n == '`') {
+                        ++j;
+                    }
+                }
+                arena[pos++] = line[j];
+            }
+            if (j == line.size()) {
+                return fail("Unterminated quote");
+            }
+            i = j;
+            break;
+        }
+
+        case '\\':
+            begin_word();
+            quoted = true;
+            arena[pos++] = i + 1 < line.size() ? line[++i] : '\\';
+            break;
+
+        default:
+            begin_word();
+            arena[pos++] = c;
+            break;
+        }
+    }
+
+    if (!seen) {
+        return true;            // Blank line or comment
+    }
+    if (!end_stage()) {
+        return false;
+    }
+
+    // out.words has stopped growing, so argv pointers can be handed out now
+    size_t offset = 0;
+    for (auto &stage : out.stages) {
+        stage.argv = out.words.data() + offset;
+        offset += stage.argc + 1;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+// parse_bench.cpp
+// Measures parse_line() throughput on long pipelines against the previous
+// three-pass istringstream parser. Build and run with `make bench`.
+#include "xsh.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+// The old approach: validate with one istringstream pass, then split on '|'
+// and tokenize every segment again into fresh strings
+static size_t legacy_parse(const std::string &line) {
+    std::istringstream pss(line);
+    std::string segment;
+    while (std::getline(pss, segment, '|')) {
+        std::istringstream ss(segment);
+        std::string arg;
+        int count = 0;
+        while (ss >> arg) {
+            ++count;
+        }
+        if (count == 0) {
+            return 0;
+        }
+    }
+
+    std::vector<std::string> segs;
+    std::stringstream ls(line);
+    while (std::getline(ls, segment, '|')) {
+        if (!segment.empty()) {
+            segs.push_back(segment);
+        }
+    }
+    std::vector<std::vector<std::string>> cmds;
+    for (auto &seg : segs) {
+        std::stringstream ss(seg);
+        std::string arg;
+        std::vector<std::string> argv;
+        while (ss >> arg) {
+            argv.push_back(arg);
+        }
+        cmds.push_back(argv);
+    }
+    return cmds.size();
+}
+
+// A pipeline of `stages` commands, each with a handful of arguments
+static std::string make_line(int stages) {
+    std::string line;
+    for (int i = 0; i < stages; ++i) {
+        if (i > 0) {
+            line += " | ";
+        }
+        line += "grep -v -e pattern_" + std::to_string(i) + " --color=never file_" +
+                std::to_string(i) + ".txt";
+    }
+    return line + " > out.txt";
+}
+
+template <typename F>
+static void run(const char *name, const std::string &line, long iters, F parse) {
+    size_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < iters; ++i) {
+        sink += parse(line);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("  %-8s %10.0f lines/s %9.1f MB/s %10.1f ns/line  (%zu)\n", name,
+           iters / secs, iters * line.size() / secs / 1e6, secs * 1e9 / iters, sink / iters);
+}
+
+int main(int argc, char *argv[]) {
+    // Total bytes parsed per measurement; scale with an optional argument
+    long budget = (argc > 1 ? std::atol(argv[1]) : 64) * 1000000L;
+    Pipeline pipeline;
+
+    for (int stages : {1, 8, 64, 512}) {
+        std::string line = make_line(stages);
+        long iters = budget / static_cast<long>(line.size()) + 1;
+        printf("%d stages, %zu bytes/line, %ld lines\n", stages, line.size(), iters);
+        run("lexer", line, iters, [&](const std::string &l) {
+            parse_line(l, pipeline);
+            return pipeline.stages.size();
+        });
+        run("legacy", line, iters, legacy_parse);
+    }
+    return 0;
+}
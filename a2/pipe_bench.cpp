@@ -0,0 +1,58 @@
+// pipe_bench.cpp
+// Pushes data through N-stage pipelines launched by the shell's own
+// launch_pipeline() and reports bytes/s and context switches for several
+// pipe capacities. Build and run with `make bench`.
+//
+// usage: pipe_bench [MiB per run] [stage counts...]
+#include "xsh.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char *argv[]) {
+    long mib = argc > 1 ? std::atol(argv[1]) : 256;
+    std::vector<int> stage_counts;
+    for (int i = 2; i < argc; ++i) {
+        stage_counts.push_back(std::atoi(argv[i]));
+    }
+    if (stage_counts.empty()) {
+        stage_counts = {2, 4, 8};
+    }
+    const long sizes[] = {0, 256 << 10, 1 << 20};
+    long bytes = mib << 20;
+
+    printf("%-7s %-10s %10s %12s %10s %10s\n",
+           "stages", "pipe", "MiB/s", "ctx-switch", "user s", "sys s");
+    Pipeline pipeline;
+    for (int stages : stage_counts) {
+        // A producer followed by (stages - 1) copying stages
+        std::string line = "head -c " + std::to_string(bytes) + " /dev/zero";
+        for (int i = 1; i < stages; ++i) {
+            line += " | cat";
+        }
+        line += " > /dev/null";
+        if (!parse_line(line, pipeline)) {
+            return 1;
+        }
+
+        for (long size : sizes) {
+            set_pipe_size(size);
+            PipelineStats stats;
+            if (run_measured(pipeline.stages, stats) != 0) {
+                fprintf(stderr, "pipe_bench: pipeline failed\n");
+                return 1;
+            }
+            long switches = 0;
+            double user = 0, sys = 0;
+            for (const auto &st : stats.stages) {
+                switches += st.nvcsw + st.nivcsw;
+                user += st.user;
+                sys += st.sys;
+            }
+            std::string label = size ? std::to_string(size >> 10) + "KiB" : "default";
+            printf("%-7d %-10s %10.1f %12ld %10.3f %10.3f\n", stages, label.c_str(),
+                   mib / stats.wall, switches, user, sys);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,291 @@
+// stats.cpp
+#include "xsh.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// Where finished pipelines are reported
+enum StatsMode { STATS_OFF, STATS_ON, STATS_JSON };
+
+static StatsMode stats_mode = STATS_OFF;
+static std::string stats_log;         // JSON log path for STATS_JSON
+
+bool stats_enabled() {
+    return stats_mode != STATS_OFF;
+}
+
+static double seconds(const struct timeval &tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static double since_us(Clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - t).count();
+}
+
+// Record a reaped stage's status and rusage
+static void finish_stage(StageStats &st, int status, const struct rusage &ru) {
+    st.wall = since_us(st.started) / 1e6;
+    st.status = exit_status(status);
+    st.user = seconds(ru.ru_utime);
+    st.sys = seconds(ru.ru_stime);
+    st.max_rss_kb = ru.ru_maxrss;
+    st.nvcsw = ru.ru_nvcsw;
+    st.nivcsw = ru.ru_nivcsw;
+}
+
+// Reap a stage whose child has exited (or block until it does)
+static void reap_stage(StageStats &st) {
+    int status = 0;
+    struct rusage ru = {};
+    while (wait4(st.pid, &status, 0, &ru) < 0 && errno == EINTR) {
+    }
+    finish_stage(st, status, ru);
+}
+
+// Read the time the child wrote just before exec. EOF without one means it
+// died before getting that far, and exec_us stays unset
+static void read_exec_probe(StageStats &st) {
+    Clock::rep stamp;
+    ssize_t n;
+    while ((n = read(st.exec_fd, &stamp, sizeof(stamp))) < 0 && errno == EINTR) {
+    }
+    if (n == sizeof(stamp)) {
+        Clock::time_point at{Clock::duration(stamp)};
+        st.exec_us = std::chrono::duration<double, std::micro>(at - st.started).count();
+    }
+    close(st.exec_fd);
+    st.exec_fd = -1;
+}
+
+int poll_stages(PipelineStats &stats, int timeout_ms) {
+    std::vector<struct pollfd> fds;
+    std::vector<StageStats *> owner;
+    for (auto &st : stats.stages) {
+        if (st.pid_fd >= 0) {
+            fds.push_back({st.pid_fd, POLLIN, 0});
+            owner.push_back(&st);
+        }
+        if (st.exec_fd >= 0) {
+            fds.push_back({st.exec_fd, POLLIN, 0});
+            owner.push_back(&st);
+        }
+    }
+    if (fds.empty()) {
+        return 0;
+    }
+    if (poll(fds.data(), fds.size(), timeout_ms) < 0) {
+        if (errno == EINTR) {
+            return static_cast<int>(fds.size());
+        }
+        perror("poll");
+        return -1;
+    }
+
+    int still_open = static_cast<int>(fds.size());
+    for (size_t k = 0; k < fds.size(); ++k) {
+        if (!fds[k].revents) {
+            continue;
+        }
+        StageStats &st = *owner[k];
+        if (fds[k].fd == st.pid_fd) {
+            reap_stage(st);         // Stamped now, when the exit is seen
+            close(st.pid_fd);
+            st.pid_fd = -1;
+        } else {
+            read_exec_probe(st);
+        }
+        --still_open;
+    }
+    return still_open;
+}
+
+// Wait for every stage with poll() on a pidfd per child, so each stage is
+// timed when it actually exits rather than when its turn to be waited for
+// comes. Exec probes are read alongside. Stages without a pidfd (or all of
+// them, if poll fails) are waited for in order
+static void wait_measured(PipelineStats &stats) {
+    while (poll_stages(stats, -1) > 0) {
+    }
+
+    for (auto &st : stats.stages) {
+        if (st.pid < 0) {
+            st.status = 1;
+            continue;
+        }
+        if (st.pid_fd >= 0) {
+            close(st.pid_fd);
+            st.pid_fd = -1;
+        }
+        if (st.wall == 0) {
+            reap_stage(st);
+        }
+        if (st.exec_fd >= 0) {
+            read_exec_probe(st);    // Written or closed by now: the child is gone
+        }
+    }
+}
+
+// Builtins run in the shell, so their cost is the shell's own rusage plus
+// that of any children they reaped (e.g. parallel's jobs)
+static int run_measured_builtin(const Command &cmd, PipelineStats &stats) {
+    struct rusage self0, kids0, self1, kids1;
+    getrusage(RUSAGE_SELF, &self0);
+    getrusage(RUSAGE_CHILDREN, &kids0);
+    stats.stages.resize(1);
+    StageStats &st = stats.stages[0];
+    st.pid = getpid();
+    st.name = cmd.argv[0];
+    st.started = Clock::now();
+
+    st.status = run_builtin(cmd);
+
+    st.wall = since_us(st.started) / 1e6;
+    getrusage(RUSAGE_SELF, &self1);
+    getrusage(RUSAGE_CHILDREN, &kids1);
+    st.user = seconds(self1.ru_utime) - seconds(self0.ru_utime) +
+              seconds(kids1.ru_utime) - seconds(kids0.ru_utime);
+    st.sys = seconds(self1.ru_stime) - seconds(self0.ru_stime) +
+             seconds(kids1.ru_stime) - seconds(kids0.ru_stime);
+    st.max_rss_kb = std::max(self1.ru_maxrss, kids1.ru_maxrss);
+    st.nvcsw = self1.ru_nvcsw - self0.ru_nvcsw + kids1.ru_nvcsw - kids0.ru_nvcsw;
+    st.nivcsw = self1.ru_nivcsw - self0.ru_nivcsw + kids1.ru_nivcsw - kids0.ru_nivcsw;
+    st.fork_us = 0;
+    st.exec_us = 0;
+    return st.status;
+}
+
+int run_measured(const std::vector<Command> &commands, PipelineStats &stats) {
+    if (commands.size() == 1 && commands[0].argc > 0 && is_builtin(commands[0].argv[0])) {
+        stats.status = run_measured_builtin(commands[0], stats);
+        stats.wall = stats.stages[0].wall;
+        return stats.status;
+    }
+
+    launch_pipeline(commands, &stats);
+    wait_measured(stats);
+
+    if (stats.stages.front().pid < 0) {
+        stats.status = 1;
+        return stats.status;
+    }
+    Clock::time_point first = stats.stages.front().started;
+    for (const auto &st : stats.stages) {
+        if (st.pid < 0) {
+            continue;
+        }
+        double end = std::chrono::duration<double>(st.started - first).count() + st.wall;
+        stats.wall = std::max(stats.wall, end);
+    }
+    stats.status = stats.stages.back().pid < 0 ? 1 : stats.stages.back().status;
+    return stats.status;
+}
+
+// Quote s as a JSON string
+static std::string json_string(const std::string &s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static std::string format_summary(const PipelineStats &stats) {
+    double user = 0, sys = 0;
+    for (const auto &st : stats.stages) {
+        user += st.user;
+        sys += st.sys;
+    }
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "real %.3fs  user %.3fs  sys %.3fs  | parse %.1fus  launch %.1fus  | status %d\n",
+             stats.wall, user, sys, stats.parse_us, stats.launch_us, stats.status);
+    std::string out = buf;
+    for (const auto &st : stats.stages) {
+        // The name can be any length, so only the numbers go through buf
+        out += "  " + st.name;
+        if (st.name.size() < 12) {
+            out.append(12 - st.name.size(), ' ');
+        }
+        snprintf(buf, sizeof(buf),
+                 " pid %-7d wall %.3fs  user %.3fs  sys %.3fs  rss %ldKB  "
+                 "csw %ld/%ld  fork %.1fus  exec %.1fus  status %d\n",
+                 st.pid, st.wall, st.user, st.sys, st.max_rss_kb,
+                 st.nvcsw, st.nivcsw, st.fork_us, st.exec_us, st.status);
+        out += buf;
+    }
+    return out;
+}
+
+static std::string format_json(const PipelineStats &stats) {
+    char buf[512];
+    snprintf(buf, sizeof(buf), ",\"status\":%d,\"wall_s\":%.6f,\"parse_us\":%.2f,\"launch_us\":%.2f,\"stages\":[",
+             stats.status, stats.wall, stats.parse_us, stats.launch_us);
+    std::string out = "{\"command\":" + json_string(stats.command) + buf;
+    for (size_t i = 0; i < stats.stages.size(); ++i) {
+        const StageStats &st = stats.stages[i];
+        // The name can be any length, so it is appended directly; only the
+        // fixed-width numbers go through buf
+        out += i ? ",{\"pid\":" : "{\"pid\":";
+        out += std::to_string(st.pid) + ",\"name\":" + json_string(st.name);
+        snprintf(buf, sizeof(buf),
+                 ",\"status\":%d,\"wall_s\":%.6f,\"user_s\":%.6f,"
+                 "\"sys_s\":%.6f,\"max_rss_kb\":%ld,\"nvcsw\":%ld,\"nivcsw\":%ld,"
+                 "\"fork_us\":%.2f,\"exec_us\":%.2f}",
+                 st.status, st.wall, st.user, st.sys, st.max_rss_kb, st.nvcsw, st.nivcsw,
+                 st.fork_us, st.exec_us);
+        out += buf;
+    }
+    return out + "]}\n";
+}
+
+void report_stats(const PipelineStats &stats, bool timed) {
+    if (timed || stats_mode == STATS_ON) {
+        std::string text = format_summary(stats);
+        write_all(STDERR_FILENO, text.data(), text.size());
+    }
+    if (stats_mode == STATS_JSON) {
+        int fd = open(stats_log.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            perror(stats_log.c_str());
+            return;
+        }
+        std::string line = format_json(stats);
+        write_all(fd, line.data(), line.size());
+        close(fd);
+    }
+}
+
+int run_stats_builtin(const Command &cmd) {
+    std::string_view arg = cmd.argc > 1 ? cmd.argv[1] : "";
+    if (arg.empty()) {
+        builtin_output(cmd, stats_mode == STATS_ON ? "stats on\n"
+                          : stats_mode == STATS_JSON ? "stats json " + stats_log + "\n"
+                          : "stats off\n");
+    } else if (arg == "on") {
+        stats_mode = STATS_ON;
+    } else if (arg == "off") {
+        stats_mode = STATS_OFF;
+    } else if (arg == "json" && cmd.argc > 2) {
+        stats_mode = STATS_JSON;
+        stats_log = cmd.argv[2];
+    } else {
+        std::cerr << "usage: stats [on | off | json FILE]\n";
+        return 2;
+    }
+    return 0;
+}
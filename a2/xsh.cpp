@@ -3,9 +3,14 @@
 #include <iostream>
 #include <unistd.h>
 #include <sys/wait.h>
-#include <sstream>
 #include <fcntl.h>
 #include <vector>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
 
 // Print the shell prompt (USERNAME and space)
 void print_prompt() {
@@ -19,79 +24,84 @@ std::string read_input() {
     return line;
 }
 
-// Validate input line format: each pipeline segment must have 1-2 tokens, or "exit" command
-bool validate_input(const std::string &line) {
-    if (line == "exit") {
-        // Allow exit command without further validation
-        return true;
-    }
-    
-    // Split line by '|' to check each pipeline segment
-    std::istringstream pss(line);
-    std::string segment;
-    while (std::getline(pss, segment, '|')) {
-        std::istringstream ss(segment);
-        std::string arg;
-        int count = 0;
-        
-        // Count tokens in segment
-        while (ss >> arg) {
-            if (++count > 2) {
-                break;  // More than 2 tokens is invalid
-            }
-        }
-        
-        // If no tokens or more than 2 were found, it's invalid
-        if (count == 0 || count > 2) {
-            std::cerr << "Invalid command format\n";
-            return false;
-        }
-    }
-    return true;
-}
-
 // Check if input line is "exit" to signal shell termination
-bool handle_exit(const std::string &line) {
+bool handle_exit(std::string_view line) {
     return line == "exit";
 }
 
-// Split a string by a delimiter and return non-empty tokens
-static std::vector<std::string> split(const std::string &s, char delim) {
-    std::vector<std::string> out;
-    std::stringstream ss(s);
-    std::string tok;
-    while (std::getline(ss, tok, delim)) {
-        if (!tok.empty()) {
-            out.push_back(tok);
+// Standard file descriptor constants
+enum { STDIN_FD = 0, STDOUT_FD = 1, STDERR_FD = 2 };
+
+// Copy everything from in to out while letting the kernel move the bytes:
+// sendfile() when the source is a regular file, splice() when either end is
+// a pipe, and a read/write loop only for what's left (e.g. a terminal)
+static int transfer_fd(int in, int out) {
+    struct stat in_st, out_st;
+    if (fstat(in, &in_st) < 0 || fstat(out, &out_st) < 0) {
+        return -1;
+    }
+    ssize_t n;
+
+    if (S_ISREG(in_st.st_mode)) {
+        while ((n = sendfile(out, in, nullptr, 1 << 30)) > 0 ||
+               (n < 0 && errno == EINTR)) {
+        }
+        if (n == 0) {
+            return 0;
+        }
+        // EINVAL means this output can't take sendfile (e.g. O_APPEND file)
+        if (errno != EINVAL && errno != ENOSYS) {
+            return -1;
         }
     }
-    return out;
-}
 
-// Parse the command line into a vector of commands, each a vector of arguments
-std::vector<std::vector<std::string>> parse_line(const std::string &line) {
-    std::vector<std::vector<std::string>> cmds;
-    
-    // Split the line into pipeline segments
-    for (auto &seg : split(line, '|')) {
-        std::stringstream ss(seg);
-        std::string arg;
-        std::vector<std::string> argv;
-        
-        // Tokenize on whitespace to get individual arguments
-        while (ss >> arg) {
-            argv.push_back(arg);
+    if (S_ISFIFO(in_st.st_mode) || S_ISFIFO(out_st.st_mode)) {
+        while ((n = splice(in, nullptr, out, nullptr, 1 << 20,
+                           SPLICE_F_MOVE | SPLICE_F_MORE)) > 0 ||
+               (n < 0 && errno == EINTR)) {
+        }
+        if (n == 0) {
+            return 0;
+        }
+        if (errno != EINVAL) {
+            return -1;
+        }
+    }
+
+    char buf[1 << 16];
+    while ((n = read(in, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        for (ssize_t off = 0; off < n;) {
+            ssize_t w = write(out, buf + off, n - off);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            off += w;
         }
-        cmds.push_back(argv);
     }
-    return cmds;
+    return 0;
 }
 
-// Standard file descriptor constants
-enum { STDIN_FD = 0, STDOUT_FD = 1 };
+// Open path in the child and move it onto target_fd, exiting on failure
+static void redirect_file(const char *path, int flags, int target_fd) {
+    int fd = open(path, flags, 0644);
+    if (fd < 0) {
+        perror(path);
+        _exit(1);
+    }
+    if (fd != target_fd) {
+        dup2(fd, target_fd);
+        close(fd);
+    }
+}
 
-// Execute a single command with optional input/output redirection
-static void execute_single(const std::vector<std::string> &args, int in_fd, int out_fd) {
+// Execute a single command with optional pipe and file redirection,
+// returning the child's pid (or -1 if fork failed)
+pid_t execute_single(const Command &cmd, int in_fd, int out_fd, int exec_fd) {
     pid_t pid = fork();
     if (pid == 0) {
         // Child process
@@ -105,45 +115,161 @@ static void execute_single(const std::vector<std::string> &args, int in_fd, int
             dup2(out_fd, STDOUT_FD);
             close(out_fd);
         }
-        
-        // Prepare arguments for exec
-        std::vector<char*> cargv;
-        for (auto &a : args) {
-            cargv.push_back(const_cast<char*>(a.c_str()));
+
+        // File redirections are opened straight onto the child's fds and
+        // take precedence over the pipe, as in sh
+        if (cmd.in_file) {
+            redirect_file(cmd.in_file, O_RDONLY, STDIN_FD);
         }
-        cargv.push_back(nullptr);
-        
-        // Execute command: absolute path if starts with '/', else search in PATH
-        if (!args.empty() && args[0].front() == '/') {
-            execv(cargv[0], cargv.data());
+        if (cmd.out_file) {
+            int mode = cmd.append ? O_APPEND : O_TRUNC;
+            redirect_file(cmd.out_file, O_WRONLY | O_CREAT | mode, STDOUT_FD);
+        }
+        if (cmd.err_file) {
+            redirect_file(cmd.err_file, O_WRONLY | O_CREAT | O_TRUNC, STDERR_FD);
+        }
+
+        // Tell a measuring shell when this stage actually got going; the
+        // probe is close-on-exec, so nothing else ever reaches it
+        if (exec_fd >= 0) {
+            Clock::rep now = Clock::now().time_since_epoch().count();
+            ssize_t ignored = write(exec_fd, &now, sizeof(now));
+            (void)ignored;
+        }
+
+        // Bare redirection: when there is input to forward ("< in > out" or a
+        // pipe feeding "> out"), the shell moves it itself instead of
+        // exec'ing cat; otherwise it just creates/truncates the files
+        if (cmd.argc == 0) {
+            bool has_input = cmd.in_file || in_fd != STDIN_FD;
+            if (has_input && transfer_fd(STDIN_FD, STDOUT_FD) < 0) {
+                perror("redirect");
+                _exit(1);
+            }
+            _exit(0);
+        }
+
+        // Execute command (argv is already NULL-terminated, so nothing is
+        // allocated after fork): absolute path if starts with '/', else PATH
+        if (cmd.argv[0][0] == '/') {
+            execv(cmd.argv[0], cmd.argv);
         } else {
-            execvp(cargv[0], cargv.data());
+            execvp(cmd.argv[0], cmd.argv);
         }
         
-        // If exec fails, print error message and terminate child
+        // If exec fails, print error message and terminate child with the
+        // conventional "not found" (127) or "not executable" (126) status
+        int err = errno;
         perror("exec");
-        exit(1);
+        _exit(err == ENOENT ? 127 : 126);
+    }
+    if (pid < 0) {
+        perror("fork");
     }
     // Parent process continues without waiting here
+    return pid;
+}
+
+// Translate a wait() status into a shell exit status
+int exit_status(int status) {
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return 1;
+}
+
+// Requested pipe capacity in bytes; 0 leaves the kernel default
+static long requested_pipe_size = 0;
+
+bool set_pipe_size(long size) {
+    if (size < 0) {
+        return false;
+    }
+    requested_pipe_size = size;
+    return true;
+}
+
+long pipe_size() {
+    return requested_pipe_size;
+}
+
+// Create a pipeline pipe. Both ends are close-on-exec so no other stage (or
+// background job) inherits a stray write end that would hold off EOF; dup2()
+// clears the flag on the copies a child actually uses
+static bool make_pipe(int fds[2]) {
+    if (pipe2(fds, O_CLOEXEC) < 0) {
+        perror("pipe");
+        return false;
+    }
+    // A bigger buffer lets producer and consumer run longer between context
+    // switches; unprivileged users are capped by /proc/sys/fs/pipe-max-size
+    if (requested_pipe_size > 0 && fcntl(fds[1], F_SETPIPE_SZ, requested_pipe_size) < 0) {
+        static bool warned = false;
+        if (!warned) {
+            perror("pipesize");
+            warned = true;
+        }
+    }
+    return true;
 }
 
-// Execute a sequence of piped commands
-void execute_commands(const std::vector<std::vector<std::string>> &commands) {
-    int in_fd = STDIN_FD;  // Input for first command
+// Start a sequence of piped commands without waiting for them
+std::vector<pid_t> launch_pipeline(const std::vector<Command> &commands,
+                                   PipelineStats *stats, int first_in) {
+    int in_fd = first_in;  // Input for first command
     int pipe_fd[2];        // File descriptors for pipe ends
+    std::vector<pid_t> pids;
+    if (stats) {
+        stats->stages.resize(commands.size());
+    }
 
     // Loop through each command in the pipeline
     for (size_t i = 0; i < commands.size(); ++i) {
         // If not the last command, create a pipe for this stage
-        if (i + 1 < commands.size()) {
-            pipe(pipe_fd);
+        // (on failure this and later stages are reported as not started)
+        if (i + 1 < commands.size() && !make_pipe(pipe_fd)) {
+            if (in_fd != STDIN_FD) {
+                close(in_fd);
+            }
+            pids.resize(commands.size(), -1);
+            break;
         }
 
         // Determine output fd: either pipe write end or standard output
         int out_fd = (i + 1 == commands.size()) ? STDOUT_FD : pipe_fd[1];
 
-        // Fork and execute this single command
-        execute_single(commands[i], in_fd, out_fd);
+        // Fork and execute this single command. When measuring, the child
+        // writes the time it reached exec into a close-on-exec probe pipe,
+        // and a pidfd lets the stage's exit be seen while later ones start
+        if (stats) {
+            StageStats &st = stats->stages[i];
+            int exec_pipe[2] = {-1, -1};
+            if (pipe2(exec_pipe, O_CLOEXEC) < 0) {
+                perror("pipe");     // The stage still runs, just without an exec time
+            }
+            st.name = commands[i].argc ? commands[i].argv[0] : "<redirect>";
+            st.started = Clock::now();
+            st.pid = execute_single(commands[i], in_fd, out_fd, exec_pipe[1]);
+            st.fork_us = std::chrono::duration<double, std::micro>(Clock::now() - st.started).count();
+            if (exec_pipe[1] >= 0) {
+                close(exec_pipe[1]);
+            }
+            if (st.pid >= 0) {
+                st.exec_fd = exec_pipe[0];
+                st.pid_fd = static_cast<int>(syscall(SYS_pidfd_open, st.pid, 0));
+            } else if (exec_pipe[0] >= 0) {
+                close(exec_pipe[0]);
+            }
+            pids.push_back(st.pid);
+
+            // Stamp earlier stages that exited while this one was forked
+            poll_stages(*stats, 0);
+        } else {
+            pids.push_back(execute_single(commands[i], in_fd, out_fd));
+        }
 
         // Close the previous input fd in the parent
         if (in_fd != STDIN_FD) {
@@ -156,13 +282,172 @@ void execute_commands(const std::vector<std::vector<std::string>> &commands) {
             in_fd = pipe_fd[0];
         }
     }
+    if (stats && !commands.empty() && stats->stages[0].pid >= 0) {
+        stats->launch_us = std::chrono::duration<double, std::micro>(
+            Clock::now() - stats->stages[0].started).count();
+    }
+    return pids;
+}
 
-    // Wait for all child processes to finish
-    for (size_t i = 0; i < commands.size(); ++i) {
-        wait(nullptr);
+// Wait for this pipeline's children by pid; the last stage decides the status
+int wait_pids(const std::vector<pid_t> &pids) {
+    int result = 0;
+    for (pid_t pid : pids) {
+        int status = 0;
+        if (pid < 0) {
+            result = 1;
+            continue;
+        }
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        result = exit_status(status);
     }
+    return result;
 }
 
+// Execute a sequence of piped commands and wait for all of them
+int execute_commands(const std::vector<Command> &commands) {
+    return wait_pids(launch_pipeline(commands));
+}
 
+// Open the ">"/">>" target of a builtin, or hand back stdout
+int open_output(const Command &cmd) {
+    if (!cmd.out_file) {
+        std::cout << std::flush;
+        return STDOUT_FD;
+    }
+    int mode = cmd.append ? O_APPEND : O_TRUNC;
+    int fd = open(cmd.out_file, O_WRONLY | O_CREAT | O_CLOEXEC | mode, 0644);
+    if (fd < 0) {
+        perror(cmd.out_file);
+    }
+    return fd;
+}
 
+// Write the whole buffer, looping over short writes and EINTR
+bool write_all(int fd, const char *buf, size_t len) {
+    for (size_t off = 0; off < len;) {
+        ssize_t n = write(fd, buf + off, len - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("write");
+            return false;
+        }
+        off += n;
+    }
+    return true;
+}
 
+// Send builtin output to stdout or to the file named by its redirection
+void builtin_output(const Command &cmd, const std::string &text) {
+    int fd = open_output(cmd);
+    if (fd < 0) {
+        return;
+    }
+    write_all(fd, text.data(), text.size());
+    if (fd != STDOUT_FD) {
+        close(fd);
+    }
+}
+
+// Commands run inside the shell process
+bool is_builtin(std::string_view name) {
+    return name == "jobs" || name == "wait" || name == "fg" || name == "parallel" ||
+           name == "stats" || name == "pipesize";
+}
+
+// Dispatch a single-stage command to its builtin
+int run_builtin(const Command &cmd) {
+    if (cmd.argc == 0 || !is_builtin(cmd.argv[0])) {
+        return -1;
+    }
+    std::string_view name = cmd.argv[0];
+    if (name == "parallel") {
+        return run_parallel(cmd);
+    }
+    if (name == "stats") {
+        return run_stats_builtin(cmd);
+    }
+    if (name == "pipesize") {
+        return run_pipesize_builtin(cmd);
+    }
+    return run_job_builtin(cmd);
+}
+
+// Show or change the pipe capacity used for new pipelines
+int run_pipesize_builtin(const Command &cmd) {
+    if (cmd.argc < 2) {
+        builtin_output(cmd, std::to_string(requested_pipe_size) + "\n");
+        return 0;
+    }
+    char *end;
+    errno = 0;
+    long size = std::strtol(cmd.argv[1], &end, 10);
+    int shift = 0;
+    if (*end == 'k' || *end == 'K') {
+        shift = 10;
+        ++end;
+    } else if (*end == 'm' || *end == 'M') {
+        shift = 20;
+        ++end;
+    }
+    if (end == cmd.argv[1] || *end != '\0') {
+        std::cerr << "usage: pipesize [bytes[k|m]]\n";
+        return 2;
+    }
+    // F_SETPIPE_SZ takes an int, so the scaled size has to fit in one
+    if (errno == ERANGE || size < 0 || size > (INT_MAX >> shift)) {
+        std::cerr << "pipesize: " << cmd.argv[1] << ": out of range\n";
+        return 2;
+    }
+    set_pipe_size(size << shift);
+    return 0;
+}
+
+// Parse and execute a single line of input
+int run_line(std::string_view line) {
+    // Reused for every line so its arena and word pool only ever grow
+    static Pipeline pipeline;
+    auto parse_start = Clock::now();
+    if (!parse_line(line, pipeline)) {
+        return 2;
+    }
+    double parse_us = std::chrono::duration<double, std::micro>(Clock::now() - parse_start).count();
+    if (pipeline.stages.empty()) {
+        return 0;
+    }
+
+    // Trim the line for job listings and stats logs
+    size_t start = line.find_first_not_of(" \t\r");
+    std::string_view text = line.substr(start);
+    text = text.substr(0, text.find_last_not_of(" \t\r") + 1);
+
+    if (pipeline.background) {
+        // Remember the line as typed, minus the trailing '&'
+        text = text.substr(0, text.rfind('&'));
+        text = text.substr(0, text.find_last_not_of(" \t") + 1);
+        return start_job(pipeline.stages, text);
+    }
+
+    // A leading "time" measures this pipeline even when stats are off
+    Command &first = pipeline.stages[0];
+    bool timed = first.argc > 1 && std::string_view(first.argv[0]) == "time";
+    if (timed) {
+        ++first.argv;
+        --first.argc;
+    }
+
+    bool builtin = pipeline.stages.size() == 1 && first.argc > 0 && is_builtin(first.argv[0]);
+    if (timed || (stats_enabled() && !builtin)) {
+        PipelineStats stats;
+        stats.command = text;
+        stats.parse_us = parse_us;
+        int status = run_measured(pipeline.stages, stats);
+        report_stats(stats, timed);
+        return status;
+    }
+    if (builtin) {
+        return run_builtin(first);
+    }
+    return execute_commands(pipeline.stages);
+}
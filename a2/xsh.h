@@ -2,8 +2,61 @@
 #ifndef XSH_H
 #define XSH_H
 
+#include <chrono>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <sys/types.h>
+
+// One pipeline stage. The strings point into the storage of whoever built
+// it (normally a Pipeline's arena) and stay valid as long as that does
+struct Command {
+    char **argv = nullptr;            // NULL-terminated; argv[0] is the program
+    size_t argc = 0;                  // 0 for a bare redirection ("< in > out")
+    const char *in_file = nullptr;    // Target of "<"
+    const char *out_file = nullptr;   // Target of ">" or ">>"
+    const char *err_file = nullptr;   // Target of "2>"
+    bool append = false;              // true when stdout uses ">>"
+};
+
+// A parsed input line. The arena and word pool are reused from one line to
+// the next, so parsing a line no bigger than earlier ones allocates nothing
+struct Pipeline {
+    std::vector<Command> stages;
+    bool background = false;          // Line ended in '&'
+    std::vector<char> arena;          // Unescaped words, each NUL-terminated
+    std::vector<char *> words;        // Every stage's argv, back to back
+};
+
+// Clock used for every shell-side timing
+using Clock = std::chrono::steady_clock;
+
+// Resource usage of one pipeline stage, collected with wait4()
+struct StageStats {
+    pid_t pid = -1;
+    std::string name;                 // argv[0], or "<redirect>" for a bare one
+    int status = 0;                   // Exit status as the shell reports it
+    double wall = 0;                  // Seconds from fork to exit
+    double user = 0, sys = 0;         // CPU seconds
+    long max_rss_kb = 0;
+    long nvcsw = 0, nivcsw = 0;       // Voluntary / involuntary context switches
+    double fork_us = 0;               // Time the parent spent in fork()
+    double exec_us = -1;              // Fork until the child was about to exec
+    Clock::time_point started;        // Just before fork
+    int exec_fd = -1;                 // Close-on-exec probe the child writes
+                                      // its Clock::now() into before exec
+    int pid_fd = -1;                  // pidfd, readable once the child exits
+};
+
+// Measurements for one foreground pipeline
+struct PipelineStats {
+    std::string command;              // The line as typed
+    int status = 0;
+    double parse_us = 0;              // Time spent in parse_line()
+    double launch_us = 0;             // First fork until the last fork returned
+    double wall = 0;                  // First fork until the last stage exited
+    std::vector<StageStats> stages;
+};
 
 // Static username shown in prompt
 static const std::string USERNAME = "[cssc1404@assignment02]$";
@@ -14,16 +67,112 @@ void print_prompt();
 // Reads an entire line from standard input
 std::string read_input();
 
-// Validates command syntax: each segment (around pipes) must have 1–2 tokens
-bool validate_input(const std::string &line);
-
 // Checks if the command is "exit" to terminate the shell
-bool handle_exit(const std::string &line);
+bool handle_exit(std::string_view line);
+
+// Tokenizes line in a single pass into out (replacing what was there):
+// words split on whitespace, '|' between stages, "<", ">", ">>" and "2>"
+// redirections, a trailing '&', '...' and "..." quoting, backslash escapes
+// and "#" comments. Any number of stages and arguments is allowed. Returns
+// false after printing a message if the syntax is invalid
+bool parse_line(std::string_view line, Pipeline &out);
+
+// Forks one command with stdin/stdout moved to in_fd/out_fd (when they are
+// not 0/1) and its file redirections applied. If exec_fd is given, the child
+// writes its Clock::now() there just before exec. Returns the pid, or -1
+pid_t execute_single(const Command &cmd, int in_fd, int out_fd, int exec_fd = -1);
+
+// Forks every stage of a pipeline, wiring up pipes and redirections, and
+// returns the children's pids without waiting (-1 for a stage that failed).
+// With stats, also records fork latency and arms the exec-latency probes.
+// The first stage reads from first_in, which is closed once it is forked
+std::vector<pid_t> launch_pipeline(const std::vector<Command> &commands,
+                                   PipelineStats *stats = nullptr, int first_in = 0);
+
+// Handles whatever measured stages have exec'd or exited, waiting up to
+// timeout_ms (-1 for ever) for the first. Returns how many probes and pidfds
+// are still open, or -1 if poll() failed
+int poll_stages(PipelineStats &stats, int timeout_ms);
+
+// Capacity requested for pipeline pipes via F_SETPIPE_SZ; 0 keeps the kernel
+// default (64 KiB). Returns false if size is negative
+bool set_pipe_size(long size);
+long pipe_size();
+
+// Translates a wait() status into a shell exit status (128 + signal if killed)
+int exit_status(int status);
+
+// Waits for exactly the given children (never anyone else's) and returns the
+// exit status of the last one (128 + signal if it was killed)
+int wait_pids(const std::vector<pid_t> &pids);
+
+// Executes one or more commands, setting up pipes and redirections as needed.
+// Returns the exit status of the last command (128 + signal if it was killed)
+int execute_commands(const std::vector<Command> &commands);
+
+// Opens the fd builtin output should go to: the command's ">"/">>" file, or
+// stdout. Returns -1 (after reporting the error) if the file can't be opened
+int open_output(const Command &cmd);
+
+// Writes all of buf to fd, retrying short writes; returns false on error
+bool write_all(int fd, const char *buf, size_t len);
+
+// Writes builtin output to stdout, or to the command's ">"/">>" file
+void builtin_output(const Command &cmd, const std::string &text);
+
+// True if name is handled inside the shell rather than exec'd
+bool is_builtin(std::string_view name);
+
+// Runs cmd if it is a builtin, returning its exit status, or -1 if it isn't
+int run_builtin(const Command &cmd);
+
+// Parses and executes one input line; blank lines and "#" comments are
+// no-ops. Returns the pipeline's exit status, or 2 on a syntax error
+int run_line(std::string_view line);
+
+// ---- Background jobs (jobs.cpp) ----
+
+// Installs the SIGCHLD handler used to notice finished background jobs
+void init_jobs();
+
+// Starts a pipeline in the background and records it in the job table
+int start_job(const std::vector<Command> &commands, std::string_view text);
+
+// Reaps any background job children that have exited, without blocking.
+// Only pids belonging to a job are waited for. Finished jobs are removed
+// and, when report is set, announced as "[n]+ Done  text"
+void reap_jobs(bool report);
+
+// Runs cmd if it is a job builtin ("jobs", "wait", "fg"), returning its exit
+// status; returns -1 if cmd is not a builtin
+int run_job_builtin(const Command &cmd);
+
+// ---- Parallel executor (parallel.cpp) ----
+
+// parallel [-j N] [-v] command [args...] [::: input...]
+// Runs command once per input (appended, or substituted for "{}"), with at
+// most N jobs at a time. Inputs come from after ":::" or, without it, one
+// per line from stdin. Output is kept in input order. Returns the number of
+// failed jobs (capped at 101); -v prints a throughput summary to stderr
+int run_parallel(const Command &cmd);
+
+// ---- Instrumentation (stats.cpp) ----
+
+// True while "stats on" or "stats json FILE" is in effect
+bool stats_enabled();
+
+// Runs a foreground pipeline (or a single builtin) while collecting per-stage
+// wait4() rusage, fork and exec latency into stats; returns the exit status
+int run_measured(const std::vector<Command> &commands, PipelineStats &stats);
+
+// Prints stats as a summary to stderr (always when timed, otherwise if stats
+// are on) and appends it as one JSON object per line to the stats log
+void report_stats(const PipelineStats &stats, bool timed);
 
-// Splits the input line into commands by '|' and tokens by whitespace
-std::vector<std::vector<std::string>> parse_line(const std::string &line);
+// stats [on | off | json FILE]: with no argument, shows the current mode
+int run_stats_builtin(const Command &cmd);
 
-// Executes one or more commands, setting up pipes as needed
-void execute_commands(const std::vector<std::vector<std::string>> &commands);
+// pipesize [bytes]: sets (0 = default) or shows the pipeline pipe capacity
+int run_pipesize_builtin(const Command &cmd);
 
 #endif
\ No newline at end of file